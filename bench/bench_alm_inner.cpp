@@ -0,0 +1,99 @@
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include "kernels.hpp"
+#include "workspace.hpp"
+
+// usage: bench_alm_inner [m n]...
+// Cost of one ALM inner iteration on a dense m x n problem: the unfused
+// sequence (A^T * y, projection, A * p as two full passes over A) against the
+// fused alm_inner (one pass), for row- and column-major A. Bandwidth counts
+// the bytes of A each variant streams; 8 x 1000000 is the wide case where a
+// single row no longer fits a tile. Output is CSV:
+// layout,m,n,unfused_ms,fused_ms,unfused_GBs,fused_GBs,speedup,max_diff
+
+template<typename Step>
+static double milliseconds(int32_t repeats, Step step)
+{
+	auto start = std::chrono::steady_clock::now();
+	for (int32_t r = 0; r < repeats; ++r)
+		step();
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / repeats;
+}
+
+int main(int argc, char** argv) {
+	std::vector<std::pair<int32_t, int32_t>> shapes;
+	for (int i = 1; i + 1 < argc; i += 2)
+		shapes.emplace_back(std::stoi(argv[i]), std::stoi(argv[i + 1]));
+	if (shapes.empty())
+		shapes = { { 20, 100 }, { 200, 2000 }, { 1000, 10000 }, { 2000, 20000 }, { 8, 1000000 } };
+
+	std::mt19937_64 generator(42);
+	std::uniform_real_distribution<double_t> uniform(0.0, 1.0);
+	const double_t sigma = 0.01;
+	const double_t t = 0.001;
+
+	std::cout << "layout,m,n,unfused_ms,fused_ms,unfused_GBs,fused_GBs,speedup,max_diff" << std::endl;
+	for (auto shape : shapes) {
+		const int32_t m = shape.first;
+		const int32_t n = shape.second;
+		cvx::Problem problem = cvx::allocate_problem(m, n);
+		for (size_t i = 0; i < (size_t)m * n; ++i)
+			problem.A[i] = uniform(generator);
+		for (int32_t i = 0; i < m; ++i)
+			problem.b[i] = uniform(generator);
+		for (int32_t j = 0; j < n; ++j)
+			problem.c[j] = uniform(generator);
+
+		cvx::Workspace workspace;
+		double_t *x = workspace.zeros(n);
+		double_t *y1 = workspace.zeros(m);
+		double_t *y2 = workspace.zeros(m);
+		double_t *projection = workspace.vector(n);
+		double_t *gradient = workspace.vector(m);
+		double_t *shadow = workspace.vector(n);
+		for (int32_t j = 0; j < n; ++j)
+			x[j] = uniform(generator);
+
+		const double_t bytes = (double_t)m * n * sizeof(double_t);
+		const int32_t repeats = (int32_t)std::max<double_t>(5, 2e9 / bytes);
+		for (cvx::Layout layout : { cvx::eROW_MAJOR, cvx::eCOL_MAJOR }) {
+			if (layout == cvx::eCOL_MAJOR) {
+				std::vector<double_t> transposed((size_t)m * n);
+				for (int32_t i = 0; i < m; ++i)
+					for (int32_t j = 0; j < n; ++j)
+						transposed[(size_t)j * m + i] = problem.A[(size_t)i * n + j];
+				std::copy(transposed.begin(), transposed.end(), problem.A);
+				problem.layout = cvx::eCOL_MAJOR;
+			}
+			std::fill(y1, y1 + m, 0.0);
+			std::fill(y2, y2 + m, 0.0);
+
+			double_t unfused = milliseconds(repeats, [&]() {
+				cvx::multiply_At(problem, 1.0, y1, 0.0, shadow);
+				cvx::shifted_dual_residual(problem, x, shadow, sigma, projection);
+				cvx::project_nonneg(n, 1.0, projection, projection);
+				cvx::multiply_A(problem, 1.0, projection, 0.0, gradient);
+				cblas_daxpby(m, -1.0, problem.b, 1, 1.0, gradient, 1);
+				cblas_daxpby(m, -t, gradient, 1, 1.0, y1, 1);
+			});
+			//shadow = A^T * y2 = 0
+			std::fill(shadow, shadow + n, 0.0);
+			double_t fused = milliseconds(1, [&]() {
+				cvx::alm_inner(problem, x, sigma, t, repeats, -1.0, y2, projection, gradient, shadow);
+			}) / repeats;
+
+			double_t diff = 0.0;
+			for (int32_t i = 0; i < m; ++i)
+				diff = std::max(diff, std::abs(y1[i] - y2[i]));
+			std::cout << (layout == cvx::eROW_MAJOR ? "row" : "col") << "," << m << "," << n << ","
+				<< unfused << "," << fused << ","
+				<< 2 * bytes / unfused * 1e-6 << "," << bytes / fused * 1e-6 << ","
+				<< unfused / fused << "," << diff << std::endl;
+		}
+	}
+	return 0;
+}
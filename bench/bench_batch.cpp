@@ -0,0 +1,98 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "admm.hpp"
+#include "kernels.hpp"
+
+// usage: bench_batch [m n K]...
+// K feasible LPs sharing a dense row-major m x n A (b_k = A * x_k with sparse
+// x_k >= 0, c_k = A^T * y_k + s_k with s_k >= 0), each run for a fixed number
+// of ADMM iterations: K calls of solve_admm against one solve_admm_batch.
+// Output is CSV: m,n,K,sequential_ms,batch_ms,per_instance_speedup,max_diff
+
+static const int32_t iterations = 100;
+
+template<typename Step>
+static double milliseconds(Step step)
+{
+	auto start = std::chrono::steady_clock::now();
+	step();
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char** argv) {
+	std::vector<std::vector<int32_t>> shapes;
+	for (int i = 1; i + 2 < argc; i += 3)
+		shapes.push_back({ std::stoi(argv[i]), std::stoi(argv[i + 1]), std::stoi(argv[i + 2]) });
+	if (shapes.empty())
+		shapes = { { 100, 1000, 1 }, { 100, 1000, 8 }, { 100, 1000, 32 }, { 400, 4000, 8 }, { 400, 4000, 32 } };
+
+	std::mt19937_64 generator(42);
+	std::uniform_real_distribution<double_t> uniform(0.0, 1.0);
+
+	//fixed iteration count: never converge, never stop early
+	cvx::AdmmOptions options;
+	options.outerCount = iterations;
+	options.tolerances.primal = -1.0;
+
+	//the engines print every iteration
+	std::ostringstream sink;
+	std::streambuf *console = std::cout.rdbuf();
+
+	std::cout << "m,n,K,sequential_ms,batch_ms,per_instance_speedup,max_diff" << std::endl;
+	for (const std::vector<int32_t> &shape : shapes) {
+		const int32_t m = shape[0];
+		const int32_t n = shape[1];
+		const int32_t K = shape[2];
+		cvx::Problem problem = cvx::allocate_problem(m, n);
+		for (size_t i = 0; i < (size_t)m * n; ++i)
+			problem.A[i] = uniform(generator);
+
+		std::vector<double_t> b((size_t)m * K);
+		std::vector<double_t> c((size_t)n * K);
+		std::vector<double_t> v(std::max(m, n));
+		for (int32_t k = 0; k < K; ++k) {
+			for (int32_t j = 0; j < n; ++j)
+				v[j] = uniform(generator) < 0.1 ? uniform(generator) : 0.0;
+			cvx::multiply_A(problem, 1.0, v.data(), 0.0, &b[(size_t)k * m]);
+			for (int32_t j = 0; j < n; ++j)
+				c[(size_t)k * n + j] = uniform(generator);
+			for (int32_t i = 0; i < m; ++i)
+				v[i] = uniform(generator) - 0.5;
+			cvx::multiply_At(problem, 1.0, v.data(), 1.0, &c[(size_t)k * n]);
+		}
+
+		std::cout.rdbuf(sink.rdbuf());
+		std::vector<cvx::Result> sequential(K);
+		double_t single = milliseconds([&]() {
+			for (int32_t k = 0; k < K; ++k) {
+				cvx::Problem instance = problem;
+				instance.b = &b[(size_t)k * m];
+				instance.c = &c[(size_t)k * n];
+				sequential[k] = cvx::solve_admm(instance, options);
+			}
+		});
+		std::vector<cvx::Result> batched;
+		double_t batch = milliseconds([&]() {
+			cvx::Batch instances;
+			instances.count = K;
+			instances.b = b.data();
+			instances.c = c.data();
+			batched = cvx::solve_admm_batch(problem, instances, options);
+		});
+		std::cout.rdbuf(console);
+		sink.str(std::string());
+
+		double_t diff = 0.0;
+		for (int32_t k = 0; k < K; ++k)
+			for (int32_t j = 0; j < n; ++j)
+				diff = std::max(diff, std::abs(sequential[k].x[j] - batched[k].x[j]));
+		std::cout << m << "," << n << "," << K << "," << single << "," << batch << "," << single / batch << "," << diff << std::endl;
+	}
+	return 0;
+}
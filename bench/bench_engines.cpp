@@ -0,0 +1,314 @@
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "admm.hpp"
+#include "alm.hpp"
+#include "drs.hpp"
+#include "generator.hpp"
+#include "kernels.hpp"
+#include "pool.hpp"
+#include "sparse.hpp"
+#include "ssn.hpp"
+
+// usage: bench_engines [--engines alm,ssn,admm,drs] [--sizes 20x100,...]
+//	[--densities 1] [--row-nonzeros 20] [--threads 1,2,...] [--seed s]
+//	[--iterations k] [--tolerance eps] [--max-iterations k] [--max-gb g]
+//	[--max-factor-m m]
+// Every engine on every generated instance (see generator.hpp, the same seed
+// gives the same instance), dense (density 1, row-major) and sparse (CSR),
+// for every BLAS thread count. The sparse instances are given as nonzeros
+// per row, the density is row_nonzeros / n, so that every size gets rows
+// with a few entries rather than a fixed density that leaves the small ones
+// nearly empty. Each configuration runs in a child process so that its peak
+// RSS is its own. Per configuration:
+//	matvec_GBs		bytes of A streamed per second by A * v and A^T * v
+//	seconds_per_iteration	a fixed run of --iterations outer iterations
+//	seconds_to_tolerance	a run to the scaled KKT tolerance of at most
+//				--max-iterations outer iterations (default 100000),
+//				with the iterations it took and whether it got there;
+//				empty, and reported on stderr, when it did not
+//	peak_rss_MB		of the child
+// Instances whose A would exceed --max-gb (default 4) are skipped, and so are
+// SSN, ADMM and DRS above --max-factor-m rows (default 5000), which factor an
+// m x m matrix. Defaults sweep 20x100 up to 20000x1000000 with 1, 2, 4, ...
+// hardware threads. Output is CSV, one line per configuration:
+// engine,m,n,density,threads,seed,generate_seconds,matvec_GBs,iterations,
+// seconds_per_iteration,tolerance,iterations_to_tolerance,converged,
+// seconds_to_tolerance,peak_rss_MB
+
+// swallows the lines the engines print
+class NullBuffer : public std::streambuf
+{
+protected:
+	int overflow(int c) override { return traits_type::not_eof(c); }
+	std::streamsize xsputn(const char *, std::streamsize count) override { return count; }
+};
+
+struct Config
+{
+	std::string engine;
+	int32_t m;
+	int32_t n;
+	double_t density;
+	int32_t threads;
+};
+
+struct Settings
+{
+	uint64_t seed = 1;
+	int32_t iterations = 20;
+	double_t tolerance = 1e-4;
+	// cap of the run to tolerance, far above every engine's default budget
+	int32_t maxIterations = 100000;
+};
+
+static double seconds_since(std::chrono::steady_clock::time_point start)
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static std::vector<std::string> split(const std::string &list)
+{
+	std::vector<std::string> items;
+	std::stringstream stream(list);
+	for (std::string item; std::getline(stream, item, ',');)
+		if (!item.empty())
+			items.push_back(item);
+	return items;
+}
+
+static cvx::Result solve(const std::string &engine, const cvx::Problem &problem, int32_t outerCount, double_t tolerance)
+{
+	cvx::Tolerances tolerances;
+	tolerances.primal = tolerances.dual = tolerances.gap = tolerance;
+	cvx::TraceOptions trace;
+	trace.printInterval = 0;
+	if (engine == "alm") {
+		cvx::AlmOptions options;
+		options.tolerances = tolerances;
+		options.trace = trace;
+		if (outerCount > 0)
+			options.outerCount = outerCount;
+		return cvx::solve_alm(problem, options);
+	}
+	if (engine == "ssn") {
+		cvx::SsnOptions options;
+		options.tolerances = tolerances;
+		options.trace = trace;
+		if (outerCount > 0)
+			options.outerCount = outerCount;
+		return cvx::solve_ssn(problem, options);
+	}
+	if (engine == "admm") {
+		cvx::AdmmOptions options;
+		options.tolerances = tolerances;
+		options.trace = trace;
+		if (outerCount > 0)
+			options.outerCount = outerCount;
+		return cvx::solve_admm(problem, options);
+	}
+	cvx::DrsOptions options;
+	options.tolerances = tolerances;
+	options.trace = trace;
+	if (outerCount > 0)
+		options.outerCount = outerCount;
+	return cvx::solve_drs(problem, options);
+}
+
+// the measurements of one configuration, in the child
+static std::string run(const Config &config, const Settings &settings)
+{
+	cvx::set_blas_threads(config.threads);
+
+	auto start = std::chrono::steady_clock::now();
+	cvx::GeneratorOptions generate;
+	generate.m = config.m;
+	generate.n = config.n;
+	generate.density = config.density;
+	generate.seed = settings.seed;
+	cvx::Problem problem = cvx::generate_problem(generate);
+	double generated = seconds_since(start);
+
+	//A * v and A^T * v until a quarter second has passed
+	std::vector<double_t> v(config.n, 1.0);
+	std::vector<double_t> w(config.m, 1.0);
+	double bytes = problem.is_sparse() ? 12.0 * problem.sparse->nnz() + 8.0 * (config.m + 1) : 8.0 * config.m * config.n;
+	int32_t products = 0;
+	start = std::chrono::steady_clock::now();
+	do {
+		cvx::multiply_A(problem, 1.0, v.data(), 0.0, w.data());
+		cvx::multiply_At(problem, 1.0, w.data(), 0.0, v.data());
+		//keep the values bounded
+		std::fill(v.begin(), v.end(), 1.0);
+		products += 2;
+	} while (seconds_since(start) < 0.25);
+	double bandwidth = bytes * products / seconds_since(start) * 1e-9;
+
+	start = std::chrono::steady_clock::now();
+	cvx::Result fixed = solve(config.engine, problem, settings.iterations, -1.0);
+	double perIteration = seconds_since(start) / std::max(fixed.iterations, 1);
+
+	start = std::chrono::steady_clock::now();
+	cvx::Result converged = solve(config.engine, problem, settings.maxIterations, settings.tolerance);
+	double toTolerance = seconds_since(start);
+
+	std::ostringstream line;
+	line.precision(6);
+	line << config.engine << "," << config.m << "," << config.n << "," << config.density << "," << config.threads << ","
+		<< settings.seed << "," << generated << "," << bandwidth << "," << fixed.iterations << "," << perIteration << ","
+		<< settings.tolerance << "," << converged.iterations << "," << converged.converged << ",";
+	//a run that hit the cap measured the cap, not the time to tolerance
+	if (converged.converged)
+		line << toTolerance;
+	return line.str();
+}
+
+// forks, runs config in the child and prints its line with the peak RSS
+static void measure(const Config &config, const Settings &settings)
+{
+	int channel[2];
+	if (pipe(channel) != 0)
+		throw cvx::Error("pipe failed");
+	std::cout.flush();
+	pid_t child = fork();
+	if (child < 0)
+		throw cvx::Error("fork failed");
+	if (child == 0) {
+		close(channel[0]);
+		NullBuffer null;
+		std::cout.rdbuf(&null);
+		std::string line;
+		int status = 0;
+		try {
+			line = run(config, settings);
+		}
+		catch (const std::exception &e) {
+			line = std::string("error: ") + e.what();
+			status = 1;
+		}
+		ssize_t written = write(channel[1], line.data(), line.size());
+		close(channel[1]);
+		_exit(written == (ssize_t)line.size() ? status : 1);
+	}
+
+	close(channel[1]);
+	std::string line;
+	char buffer[4096];
+	for (ssize_t got; (got = read(channel[0], buffer, sizeof(buffer))) > 0;)
+		line.append(buffer, got);
+	close(channel[0]);
+	int status = 0;
+	struct rusage usage;
+	wait4(child, &status, 0, &usage);
+	if (!WIFEXITED(status) || WEXITSTATUS(status) != 0 || line.compare(0, 6, "error:") == 0) {
+		std::cerr << config.engine << " " << config.m << "x" << config.n << " density " << config.density
+			<< " threads " << config.threads << " failed: " << (line.empty() ? "child died" : line) << std::endl;
+		return;
+	}
+	if (line.back() == ',')
+		std::cerr << config.engine << " " << config.m << "x" << config.n << " density " << config.density
+			<< " threads " << config.threads << " did not converge within " << settings.maxIterations << " iterations" << std::endl;
+	//ru_maxrss is in kilobytes on Linux
+	std::cout << line << "," << usage.ru_maxrss / 1024.0 << std::endl;
+}
+
+int main(int argc, char** argv) {
+	std::vector<std::string> engines = { "alm", "ssn", "admm", "drs" };
+	std::vector<std::string> sizes = { "20x100", "200x2000", "2000x20000", "20000x1000000" };
+	std::vector<double_t> densities = { 1.0 };
+	std::vector<int32_t> rowNonzeros = { 20 };
+	std::vector<int32_t> threads;
+	Settings settings;
+	double_t maxGigabytes = 4.0;
+	int32_t maxFactorM = 5000;
+	try {
+		for (int i = 1; i < argc; ++i) {
+			std::string arg = argv[i];
+			if (i + 1 == argc)
+				throw cvx::Error(arg + " needs a value");
+			std::string value = argv[++i];
+			if (arg == "--engines") { engines = split(value); }
+			else if (arg == "--sizes") { sizes = split(value); }
+			else if (arg == "--densities") {
+				densities.clear();
+				for (const std::string &item : split(value))
+					densities.push_back(std::stod(item));
+			}
+			else if (arg == "--row-nonzeros") {
+				rowNonzeros.clear();
+				for (const std::string &item : split(value))
+					rowNonzeros.push_back(std::stoi(item));
+			}
+			else if (arg == "--threads") {
+				threads.clear();
+				for (const std::string &item : split(value))
+					threads.push_back(std::stoi(item));
+			}
+			else if (arg == "--seed") { settings.seed = std::stoull(value); }
+			else if (arg == "--iterations") { settings.iterations = std::stoi(value); }
+			else if (arg == "--tolerance") { settings.tolerance = std::stod(value); }
+			else if (arg == "--max-iterations") { settings.maxIterations = std::stoi(value); }
+			else if (arg == "--max-gb") { maxGigabytes = std::stod(value); }
+			else if (arg == "--max-factor-m") { maxFactorM = std::stoi(value); }
+			else { throw cvx::Error("unknown option " + arg); }
+		}
+		for (const std::string &engine : engines)
+			if (engine != "alm" && engine != "ssn" && engine != "admm" && engine != "drs")
+				throw cvx::Error("unknown engine " + engine);
+	}
+	catch (const std::exception &e) {
+		std::cerr << e.what() << std::endl;
+		return 2;
+	}
+	if (threads.empty()) {
+		int32_t hardware = std::max(1u, std::thread::hardware_concurrency());
+		for (int32_t t = 1; t < hardware; t *= 2)
+			threads.push_back(t);
+		threads.push_back(hardware);
+	}
+
+	try {
+		std::cout << "engine,m,n,density,threads,seed,generate_seconds,matvec_GBs,iterations,seconds_per_iteration,"
+			"tolerance,iterations_to_tolerance,converged,seconds_to_tolerance,peak_rss_MB" << std::endl;
+		for (const std::string &size : sizes) {
+			size_t x = size.find('x');
+			if (x == std::string::npos)
+				throw cvx::Error("size " + size + " is not m x n");
+			const int32_t m = std::stoi(size.substr(0, x));
+			const int32_t n = std::stoi(size.substr(x + 1));
+			std::vector<double_t> sizeDensities = densities;
+			for (int32_t count : rowNonzeros) {
+				if (count < n)
+					sizeDensities.push_back((double_t)count / n);
+			}
+			for (double_t density : sizeDensities) {
+				//values, plus column indices for CSR
+				double_t gigabytes = (double_t)m * n * (density < 1.0 ? 12.0 * density : 8.0) * 1e-9;
+				if (gigabytes > maxGigabytes) {
+					std::cerr << "skipping " << size << " at density " << density << ": A needs " << gigabytes << " GB" << std::endl;
+					continue;
+				}
+				for (const std::string &engine : engines) {
+					if (engine != "alm" && m > maxFactorM) {
+						std::cerr << "skipping " << engine << " on " << size << ": m x m factorization" << std::endl;
+						continue;
+					}
+					for (int32_t count : threads)
+						measure({ engine, m, n, density, count }, settings);
+				}
+			}
+		}
+	}
+	catch (const std::exception &e) {
+		std::cerr << e.what() << std::endl;
+		return 1;
+	}
+	return 0;
+}
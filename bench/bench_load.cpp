@@ -0,0 +1,79 @@
+#include <charconv>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <sys/stat.h>
+#include "numeric_csv.hpp"
+#include "problem.hpp"
+#include "workspace.hpp"
+
+// usage: bench_load [rows] [cols] [file]
+// Writes a rows x cols CSV of uniform [0,1) values to file (once, reused on
+// later runs) and times NumericCsv scan + parse for 1, 2, 4, ... hardware
+// threads. The defaults give a ~2.2 GB file. Output is CSV:
+// threads,seconds,MB/s,speedup
+
+static void generate(const std::string &path, int64_t rows, int64_t cols)
+{
+	FILE *file = fopen(path.c_str(), "wb");
+	if (file == nullptr)
+		throw cvx::Error(std::string("Failed to create ").append(path));
+
+	uint64_t state = 88172645463325252ull;
+	std::vector<char> line(cols * 32);
+	for (int64_t i = 0; i < rows; ++i) {
+		char *p = line.data();
+		for (int64_t j = 0; j < cols; ++j) {
+			//xorshift64
+			state ^= state << 13;
+			state ^= state >> 7;
+			state ^= state << 17;
+			double value = (state >> 11) * (1.0 / 9007199254740992.0);
+			p = std::to_chars(p, p + 32, value, std::chars_format::fixed, 6).ptr;
+			*p++ = j + 1 < cols ? ',' : '\n';
+		}
+		fwrite(line.data(), 1, p - line.data(), file);
+	}
+	fclose(file);
+}
+
+int main(int argc, char** argv) {
+	int64_t rows = argc > 1 ? std::stoll(argv[1]) : 5000;
+	int64_t cols = argc > 2 ? std::stoll(argv[2]) : 50000;
+	std::string path = argc > 3 ? argv[3] : "bench_load_" + std::to_string(rows) + "x" + std::to_string(cols) + ".csv";
+
+	try {
+		struct stat info;
+		if (stat(path.c_str(), &info) != 0) {
+			std::cerr << "generating " << path << std::endl;
+			generate(path, rows, cols);
+			stat(path.c_str(), &info);
+		}
+		double megabytes = info.st_size / 1e6;
+
+		int32_t hardware = std::max(1u, std::thread::hardware_concurrency());
+		double baseline = 0.0;
+		std::cout << "threads,seconds,MB/s,speedup" << std::endl;
+		for (int32_t threads = 1; ; threads = std::min(threads * 2, hardware)) {
+			auto start = std::chrono::steady_clock::now();
+			cvx::NumericCsv csv(path, threads);
+			cvx::Workspace workspace;
+			double_t *out = workspace.vector(csv.rows() * csv.cols());
+			csv.read(out);
+			double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+			if (threads == 1)
+				baseline = seconds;
+			std::cout << threads << "," << seconds << "," << megabytes / seconds << "," << baseline / seconds << std::endl;
+			if (threads == hardware)
+				break;
+		}
+	}
+	catch (const std::exception &e) {
+		std::cerr << e.what() << std::endl;
+		return 1;
+	}
+	return 0;
+}
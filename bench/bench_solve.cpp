@@ -0,0 +1,80 @@
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include "linear_solver.hpp"
+#include "workspace.hpp"
+
+// usage: bench_solve [sizes...]
+// Per-iteration cost of the Newton/ADMM linear solve for an m x m SPD system:
+// the old explicit inverse (dgetrf + dgetri + dgemv) against SpdSolver
+// (dpotrf + dpotrs). Output is CSV: m,inverse_ms,cholesky_ms,speedup,max_diff
+
+template<typename Step>
+static double milliseconds(int32_t repeats, Step step)
+{
+	auto start = std::chrono::steady_clock::now();
+	for (int32_t r = 0; r < repeats; ++r)
+		step();
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / repeats;
+}
+
+int main(int argc, char** argv) {
+	std::vector<int32_t> sizes;
+	for (int i = 1; i < argc; ++i)
+		sizes.push_back(std::stoi(argv[i]));
+	if (sizes.empty())
+		sizes = { 100, 250, 500, 1000, 2000 };
+
+	std::mt19937_64 generator(42);
+	std::uniform_real_distribution<double_t> uniform(0.0, 1.0);
+
+	std::cout << "m,inverse_ms,cholesky_ms,speedup,max_diff" << std::endl;
+	for (int32_t m : sizes) {
+		const int32_t n = 2 * m;
+		cvx::Workspace workspace;
+		double_t *B = workspace.vector(m * n);
+		double_t *system = workspace.vector(m * m);
+		double_t *inverse = workspace.vector(m * m);
+		double_t *rhs = workspace.vector(m);
+		double_t *x1 = workspace.vector(m);
+		double_t *x2 = workspace.vector(m);
+		//LAPACK takes blas_int, 64-bit in the ILP64 builds
+		const blas_int order = m;
+		std::vector<blas_int> ipiv(m);
+		blas_int size = (blas_int)m * m;
+		double_t *work = workspace.vector(size);
+		blas_int info;
+
+		//system = B * B^T + I, as in the SSN Jacobian
+		for (int32_t i = 0; i < m * n; ++i)
+			B[i] = uniform(generator);
+		for (int32_t i = 0; i < m; ++i)
+			rhs[i] = uniform(generator);
+		cblas_dgemm(CblasRowMajor, CblasNoTrans, CblasTrans, m, m, n, 1.0, B, n, B, n, 0.0, system, m);
+		for (int32_t i = 0; i < m; ++i)
+			system[i*m + i] += 1.0;
+
+		int32_t repeats = std::max(1, 200000000 / (m * m * m));
+		double_t old = milliseconds(repeats, [&]() {
+			cblas_dcopy(m * m, system, 1, inverse, 1);
+			dgetrf(&order, &order, inverse, &order, ipiv.data(), &info);
+			dgetri(&order, inverse, &order, ipiv.data(), work, &size, &info);
+			cblas_dgemv(CblasRowMajor, CblasNoTrans, m, m, 1.0, inverse, m, rhs, 1, 0.0, x1, 1);
+		});
+
+		cvx::SpdSolver solver;
+		double_t current = milliseconds(repeats, [&]() {
+			solver.factor(system, m);
+			cblas_dcopy(m, rhs, 1, x2, 1);
+			solver.solve(x2);
+		});
+
+		double_t diff = 0.0;
+		for (int32_t i = 0; i < m; ++i)
+			diff = std::max(diff, std::abs(x1[i] - x2[i]));
+		std::cout << m << "," << old << "," << current << "," << old / current << "," << diff << std::endl;
+	}
+	return 0;
+}
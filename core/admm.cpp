@@ -0,0 +1,443 @@
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include "admm.hpp"
+#include "anderson.hpp"
+#include "kernels.hpp"
+#include "profile.hpp"
+#include "linear_solver.hpp"
+#include "workspace.hpp"
+
+namespace cvx {
+
+	Result solve_admm(const Problem &problem, const AdmmOptions &options, const Result *start)
+	{
+		Profiler profiler(options.profile, "admm");
+		const int32_t m = problem.m;
+		const int32_t n = problem.n;
+		//a resumed run continues with the t residual balancing left it at
+		double_t t = start != nullptr && start->penalty > 0.0 ? start->penalty : options.t;
+		double_t k = options.k;
+		if (t <= 0.0 || k <= 0.0) {
+			double_t norm = estimate_norm(problem);
+			if (t <= 0.0)
+				t = options.penaltyScale * penalty_scale(problem, norm);
+			if (k <= 0.0)
+				k = 1e-9 * t * norm * norm;
+		}
+		const double_t *c = problem.c;
+
+		Workspace workspace;
+		//x and s side by side, the iterate Anderson accelerates
+		double_t *x = workspace.vector(2 * n);
+		double_t *s = x + n;
+		double_t *point = workspace.vector(2 * n);
+		double_t *y = workspace.vector(m);
+		double_t *system = workspace.vector((size_t)m * m);
+		double_t *tempm = workspace.vector(m);
+		double_t *tempn = workspace.vector(n);
+		double_t *relaxed = workspace.vector(n);
+		double_t *previous = workspace.vector(n);
+		//y of the plain step that produced T(v) of the last accepted point
+		double_t *acceptedY = workspace.vector(m);
+
+		initial_iterate(start ? &start->x : nullptr, x, n);
+		initial_iterate(start ? &start->s : nullptr, s, n);
+		initial_iterate(start ? &start->y : nullptr, y, m);
+		cblas_dcopy(m, y, 1, acceptedY, 1);
+
+		//system = A * A^T = Q * L * Q^T once, every t then solves with
+		//t * A * A^T + k * I = Q * (t * L + k * I) * Q^T; k keeps its ratio to t
+		gram(problem, 1.0, 0.0, system);
+		SpectralSolver solver;
+		solver.decompose(system, m);
+		const double_t ratio = k / t;
+		solver.set_shift(t, ratio * t);
+		const double_t alpha = options.alpha;
+		const double_t normB = cblas_dnrm2(m, problem.b, 1);
+		const double_t normC = cblas_dnrm2(n, c, 1);
+		int32_t balanceInterval = options.penaltyInterval;
+		int32_t nextBalance = options.penaltyInterval;
+		Anderson anderson(2 * n, 0, options.andersonMemory);
+
+		Trace trace(options.trace);
+		Checkpointer checkpointer(options.checkpoint, "admm", problem);
+		//the iterate handed to the checkpoint writer and returned: the plain
+		//(x, s, y) of the last accepted point. After an Anderson step (x, s)
+		//may be an extrapolation, whose s can be negative, or the fallback
+		//T(v_-), while y is that of the step just taken; a converged state
+		//is taken before the step and is plain already
+		auto snapshot = [&](Result state) {
+			const double_t *plainX = x;
+			const double_t *plainY = y;
+			if (!state.converged && anderson.extrapolated())
+				plainX = anderson.accepted();
+			if (!state.converged && anderson.rejected())
+				plainY = acceptedY;
+			state.x.assign(plainX, plainX + n);
+			state.s.assign(plainX + n, plainX + 2 * n);
+			state.y.assign(plainY, plainY + m);
+			state.penalty = t;
+			state.primal = primal_objective(problem, plainX);
+			state.dual = dual_objective(problem, plainY);
+			return state;
+		};
+
+		Result result;
+		const int32_t first = start ? start->iterations : 0;
+		result.iterations = first;
+		//the balancing schedule depends on the iteration count alone
+		while (options.penaltyInterval > 0 && nextBalance <= first) {
+			balanceInterval *= 2;
+			nextBalance += balanceInterval;
+		}
+		for (int32_t outer = first; outer < options.outerCount; ++outer) {
+			//point = (x, s), the argument of this step of the fixed-point map
+			cblas_dcopy(2 * n, x, 1, point, 1);
+
+			//update of y
+			//tempn = x - t * c + t * s
+			cblas_daxpby(n, 1.0, x, 1, 0.0, tempn, 1);
+			cblas_daxpby(n, -t, c, 1, 1.0, tempn, 1);
+			cblas_daxpby(n, t, s, 1, 1.0, tempn, 1);
+			//tempm = A * tempn
+			multiply_A(problem, 1.0, tempn, 0.0, tempm);
+			//tempm = b - tempm
+			cblas_daxpby(m, 1.0, problem.b, 1, -1.0, tempm, 1);
+			//y = system^-1 * tempm
+			cblas_dcopy(m, tempm, 1, y, 1);
+			solver.solve(y);
+
+			//update of s
+			//tempn = A^T * y
+			multiply_At(problem, 1.0, y, 0.0, tempn);
+			//relaxed = alpha * tempn + (1 - alpha) * (c - s)
+			cblas_dcopy(n, s, 1, previous, 1);
+			cblas_dcopy(n, c, 1, relaxed, 1);
+			cblas_daxpy(n, -1.0, previous, 1, relaxed, 1);
+			cblas_daxpby(n, alpha, tempn, 1, 1.0 - alpha, relaxed, 1);
+			//s = -1/t * x + c - relaxed
+			cblas_daxpby(n, -1.0/t, x, 1, 0.0, s, 1);
+			cblas_daxpby(n, 1.0, c, 1, 1.0, s, 1);
+			cblas_daxpby(n, -1.0, relaxed, 1, 1.0, s, 1);
+			project_nonneg(n, 1.0, s, s);
+
+			//update of x
+			//x = x + t * relaxed + t * s -t * c
+			cblas_daxpby(n, t, relaxed, 1, 1.0, x, 1);
+			cblas_daxpby(n, t, s, 1, 1.0, x, 1);
+			cblas_daxpby(n, -t, c, 1, 1.0, x, 1);
+
+			result.iterations = outer + 1;
+			const bool checked = options.checkInterval > 0 && result.iterations % options.checkInterval == 0;
+			//the objectives only feed the gap and the trace
+			result.primal = NAN;
+			result.dual = NAN;
+			if (checked || trace.sampled(result.iterations)) {
+				result.primal = primal_objective(problem, x);
+				result.dual = dual_objective(problem, y);
+			}
+
+			//residuals, tempn = A^T * y still; A * x is the one extra product
+			if (checked) {
+				//tempm = A * x - b
+				cblas_dcopy(m, problem.b, 1, tempm, 1);
+				multiply_A(problem, 1.0, x, -1.0, tempm);
+				result.residuals.primal = primal_infeasibility(problem, tempm);
+				result.residuals.dual = dual_infeasibility(problem, tempn);
+				result.residuals.gap = relative_gap(result.primal, result.dual);
+				trace.record(result.iterations, result.primal, result.dual, result.residuals);
+				if (options.tolerances.met(result.residuals)) {
+					result.converged = true;
+					break;
+				}
+			}
+			else {
+				trace.record(result.iterations, result.primal, result.dual);
+			}
+
+			//residual balancing: grow t while A^T * y + s = c lags behind, shrink
+			//it while the change of s (the dual residual of this splitting) does.
+			//x is unscaled, so only the y-system follows t
+			if (options.penaltyInterval > 0 && result.iterations == nextBalance) {
+				//balancing every so often settles t, balancing forever keeps it
+				//oscillating, so the interval doubles after each update
+				balanceInterval *= 2;
+				nextBalance += balanceInterval;
+				//relaxed = A^T * y + s - c
+				cblas_dcopy(n, tempn, 1, relaxed, 1);
+				cblas_daxpy(n, 1.0, s, 1, relaxed, 1);
+				cblas_daxpy(n, -1.0, c, 1, relaxed, 1);
+				double_t constraint = cblas_dnrm2(n, relaxed, 1) / (1.0 + normC);
+				//tempm = t * A * (s - previous)
+				cblas_daxpby(n, 1.0, s, 1, -1.0, previous, 1);
+				multiply_A(problem, t, previous, 0.0, tempm);
+				double_t change = cblas_dnrm2(m, tempm, 1) / (1.0 + normB);
+				double_t factor = 1.0;
+				if (constraint > options.balance * change)
+					factor = options.penaltyFactor;
+				else if (change > options.balance * constraint)
+					factor = 1.0 / options.penaltyFactor;
+				if (factor != 1.0) {
+					t *= factor;
+					solver.set_shift(t, ratio * t);
+					//the map itself changed, its history no longer applies
+					anderson.reset();
+				}
+			}
+
+			//(x, s) = (x, s) - dG * gamma
+			anderson.step(point, x);
+			if (!anderson.rejected())
+				cblas_dcopy(m, y, 1, acceptedY, 1);
+
+			if (checkpointer.due(result.iterations))
+				checkpointer.save(snapshot(result));
+		}
+		trace.finish(result);
+
+		result = snapshot(std::move(result));
+		checkpointer.finish(result);
+		profiler.finish(result.iterations);
+		return result;
+	}
+
+	// Per-instance state of solve_admm_batch, travels with the instance when
+	// the columns are compacted
+	struct BatchSlot
+	{
+		int32_t instance;
+		double_t t;
+		// k / t
+		double_t ratio;
+		std::unique_ptr<Anderson> anderson;
+	};
+
+	std::vector<Result> solve_admm_batch(const Problem &problem, const Batch &batch, const AdmmOptions &options)
+	{
+		const int32_t m = problem.m;
+		const int32_t n = problem.n;
+		const int32_t count = batch.count;
+		if (count <= 0)
+			return std::vector<Result>();
+		//column stride of the stacked (x, s) block
+		const int32_t ld = 2 * n;
+
+		Workspace workspace;
+		double_t *xs = workspace.zeros((size_t)ld * count);
+		double_t *point = workspace.vector((size_t)ld * count);
+		double_t *y = workspace.zeros((size_t)m * count);
+		double_t *bs = workspace.vector((size_t)m * count);
+		double_t *cs = workspace.vector((size_t)n * count);
+		double_t *system = workspace.vector((size_t)m * m);
+		double_t *tempm = workspace.vector((size_t)m * count);
+		double_t *tempn = workspace.vector((size_t)n * count);
+		double_t *relaxed = workspace.vector((size_t)n * count);
+		double_t *previous = workspace.vector((size_t)n * count);
+		//per instance, y of the plain step behind its last accepted point
+		double_t *acceptedY = workspace.zeros((size_t)m * count);
+		std::vector<double_t> scales(count);
+		std::vector<double_t> shifts(count);
+
+		for (int32_t j = 0; j < count; ++j) {
+			cblas_dcopy(m, batch.b ? batch.b + (size_t)j * m : problem.b, 1, bs + (size_t)j * m, 1);
+			cblas_dcopy(n, batch.c ? batch.c + (size_t)j * n : problem.c, 1, cs + (size_t)j * n, 1);
+		}
+		//problem with the b and c of column j
+		auto instance = [&](int32_t j) {
+			Problem view = problem;
+			view.b = bs + (size_t)j * m;
+			view.c = cs + (size_t)j * n;
+			return view;
+		};
+
+		double_t norm = 0.0;
+		if (options.t <= 0.0 || options.k <= 0.0)
+			norm = estimate_norm(problem);
+		std::vector<BatchSlot> slots(count);
+		for (int32_t j = 0; j < count; ++j) {
+			double_t t = options.t > 0.0 ? options.t : options.penaltyScale * penalty_scale(instance(j), norm);
+			double_t k = options.k > 0.0 ? options.k : 1e-9 * t * norm * norm;
+			slots[j].instance = j;
+			slots[j].t = t;
+			slots[j].ratio = k / t;
+			slots[j].anderson.reset(new Anderson(ld, 0, options.andersonMemory));
+		}
+
+		//system = A * A^T = Q * L * Q^T once for the whole batch
+		gram(problem, 1.0, 0.0, system);
+		SpectralSolver solver;
+		solver.decompose(system, m);
+		const double_t alpha = options.alpha;
+		int32_t balanceInterval = options.penaltyInterval;
+		int32_t nextBalance = options.penaltyInterval;
+
+		std::vector<Result> results(count);
+		std::vector<char> done(count);
+		//columns 0 .. active - 1 are still iterating
+		int32_t active = count;
+		//moves column j to the back of the active block, its old occupant to j
+		auto swap_columns = [&](int32_t j, int32_t last) {
+			std::swap_ranges(xs + (size_t)j * ld, xs + (size_t)(j + 1) * ld, xs + (size_t)last * ld);
+			std::swap_ranges(point + (size_t)j * ld, point + (size_t)(j + 1) * ld, point + (size_t)last * ld);
+			std::swap_ranges(y + (size_t)j * m, y + (size_t)(j + 1) * m, y + (size_t)last * m);
+			std::swap_ranges(acceptedY + (size_t)j * m, acceptedY + (size_t)(j + 1) * m, acceptedY + (size_t)last * m);
+			std::swap_ranges(bs + (size_t)j * m, bs + (size_t)(j + 1) * m, bs + (size_t)last * m);
+			std::swap_ranges(cs + (size_t)j * n, cs + (size_t)(j + 1) * n, cs + (size_t)last * n);
+			std::swap_ranges(tempn + (size_t)j * n, tempn + (size_t)(j + 1) * n, tempn + (size_t)last * n);
+			std::swap_ranges(previous + (size_t)j * n, previous + (size_t)(j + 1) * n, previous + (size_t)last * n);
+			std::swap(slots[j], slots[last]);
+			std::swap(done[j], done[last]);
+		};
+		//the plain (x, s, y) of the last accepted point, as in solve_admm
+		auto store = [&](int32_t j, int32_t iterations) {
+			Result &result = results[slots[j].instance];
+			const Anderson &anderson = *slots[j].anderson;
+			const double_t *x = xs + (size_t)j * ld;
+			const double_t *yj = y + (size_t)j * m;
+			if (!result.converged && anderson.extrapolated())
+				x = anderson.accepted();
+			if (!result.converged && anderson.rejected())
+				yj = acceptedY + (size_t)j * m;
+			result.x.assign(x, x + n);
+			result.s.assign(x + n, x + ld);
+			result.y.assign(yj, yj + m);
+			result.iterations = iterations;
+			result.penalty = slots[j].t;
+			Problem view = instance(j);
+			result.primal = primal_objective(view, x);
+			result.dual = dual_objective(view, yj);
+		};
+
+		int32_t iterations = 0;
+		for (int32_t outer = 0; outer < options.outerCount && active > 0; ++outer) {
+			//point = (x, s) of every active instance
+			cblas_dcopy((blas_int)ld * active, xs, 1, point, 1);
+
+			//update of y
+			//tempn = x - t * c + t * s
+			for (int32_t j = 0; j < active; ++j) {
+				const double_t t = slots[j].t;
+				const double_t *x = xs + (size_t)j * ld;
+				double_t *tn = tempn + (size_t)j * n;
+				cblas_daxpby(n, 1.0, x, 1, 0.0, tn, 1);
+				cblas_daxpby(n, -t, cs + (size_t)j * n, 1, 1.0, tn, 1);
+				cblas_daxpby(n, t, x + n, 1, 1.0, tn, 1);
+			}
+			//tempm = A * tempn, one pass over A for the batch
+			multiply_A_block(problem, active, 1.0, tempn, n, 0.0, tempm, m);
+			//tempm = b - tempm
+			cblas_daxpby((blas_int)m * active, 1.0, bs, 1, -1.0, tempm, 1);
+			//y = (t * A * A^T + k * I)^-1 * tempm, column by column shift
+			cblas_dcopy((blas_int)m * active, tempm, 1, y, 1);
+			for (int32_t j = 0; j < active; ++j) {
+				scales[j] = slots[j].t;
+				shifts[j] = slots[j].ratio * slots[j].t;
+			}
+			solver.solve(y, m, active, scales.data(), shifts.data());
+
+			//update of s and x
+			//tempn = A^T * y
+			multiply_At_block(problem, active, 1.0, y, m, 0.0, tempn, n);
+			for (int32_t j = 0; j < active; ++j) {
+				const double_t t = slots[j].t;
+				double_t *x = xs + (size_t)j * ld;
+				double_t *s = x + n;
+				const double_t *c = cs + (size_t)j * n;
+				double_t *tn = tempn + (size_t)j * n;
+				double_t *r = relaxed + (size_t)j * n;
+				double_t *p = previous + (size_t)j * n;
+				//relaxed = alpha * tempn + (1 - alpha) * (c - s)
+				cblas_dcopy(n, s, 1, p, 1);
+				cblas_dcopy(n, c, 1, r, 1);
+				cblas_daxpy(n, -1.0, p, 1, r, 1);
+				cblas_daxpby(n, alpha, tn, 1, 1.0 - alpha, r, 1);
+				//s = -1/t * x + c - relaxed
+				cblas_daxpby(n, -1.0/t, x, 1, 0.0, s, 1);
+				cblas_daxpby(n, 1.0, c, 1, 1.0, s, 1);
+				cblas_daxpby(n, -1.0, r, 1, 1.0, s, 1);
+				project_nonneg(n, 1.0, s, s);
+				//x = x + t * relaxed + t * s -t * c
+				cblas_daxpby(n, t, r, 1, 1.0, x, 1);
+				cblas_daxpby(n, t, s, 1, 1.0, x, 1);
+				cblas_daxpby(n, -t, c, 1, 1.0, x, 1);
+			}
+			iterations = outer + 1;
+			if (options.trace.printInterval > 0 && iterations % options.trace.printInterval == 0)
+				std::cout << "count: " << iterations << "\tactive: " << active << '\n';
+
+			//residuals, tempn = A^T * y still
+			if (options.checkInterval > 0 && iterations % options.checkInterval == 0) {
+				//tempm = A * x - b
+				cblas_dcopy((blas_int)m * active, bs, 1, tempm, 1);
+				multiply_A_block(problem, active, 1.0, xs, ld, -1.0, tempm, m);
+				for (int32_t j = 0; j < active; ++j) {
+					Problem view = instance(j);
+					Result &result = results[slots[j].instance];
+					double_t primal = primal_objective(view, xs + (size_t)j * ld);
+					double_t dual = dual_objective(view, y + (size_t)j * m);
+					result.residuals.primal = primal_infeasibility(view, tempm + (size_t)j * m);
+					result.residuals.dual = dual_infeasibility(view, tempn + (size_t)j * n);
+					result.residuals.gap = relative_gap(primal, dual);
+					done[j] = options.tolerances.met(result.residuals);
+				}
+				//converged instances leave the block
+				for (int32_t j = active - 1; j >= 0; --j) {
+					if (!done[j])
+						continue;
+					results[slots[j].instance].converged = true;
+					std::cout << "instance " << slots[j].instance << " converged\t" << results[slots[j].instance].residuals << '\n';
+					store(j, iterations);
+					swap_columns(j, --active);
+				}
+			}
+
+			//residual balancing per instance on the shared schedule
+			if (options.penaltyInterval > 0 && iterations == nextBalance) {
+				balanceInterval *= 2;
+				nextBalance += balanceInterval;
+				//previous = s - previous, tempm = A * previous
+				for (int32_t j = 0; j < active; ++j) {
+					const double_t *s = xs + (size_t)j * ld + n;
+					cblas_daxpby(n, 1.0, s, 1, -1.0, previous + (size_t)j * n, 1);
+				}
+				multiply_A_block(problem, active, 1.0, previous, n, 0.0, tempm, m);
+				for (int32_t j = 0; j < active; ++j) {
+					BatchSlot &slot = slots[j];
+					const double_t *s = xs + (size_t)j * ld + n;
+					const double_t *c = cs + (size_t)j * n;
+					double_t *r = relaxed + (size_t)j * n;
+					//relaxed = A^T * y + s - c
+					cblas_dcopy(n, tempn + (size_t)j * n, 1, r, 1);
+					cblas_daxpy(n, 1.0, s, 1, r, 1);
+					cblas_daxpy(n, -1.0, c, 1, r, 1);
+					double_t constraint = cblas_dnrm2(n, r, 1) / (1.0 + cblas_dnrm2(n, c, 1));
+					double_t change = slot.t * cblas_dnrm2(m, tempm + (size_t)j * m, 1) / (1.0 + cblas_dnrm2(m, bs + (size_t)j * m, 1));
+					double_t factor = 1.0;
+					if (constraint > options.balance * change)
+						factor = options.penaltyFactor;
+					else if (change > options.balance * constraint)
+						factor = 1.0 / options.penaltyFactor;
+					if (factor != 1.0) {
+						slot.t *= factor;
+						slot.anderson->reset();
+					}
+				}
+			}
+
+			//(x, s) = (x, s) - dG * gamma
+			for (int32_t j = 0; j < active; ++j) {
+				slots[j].anderson->step(point + (size_t)j * ld, xs + (size_t)j * ld);
+				if (!slots[j].anderson->rejected())
+					cblas_dcopy(m, y + (size_t)j * m, 1, acceptedY + (size_t)j * m, 1);
+			}
+		}
+
+		for (int32_t j = 0; j < active; ++j) {
+			store(j, iterations);
+		}
+		std::cout.flush();
+		return results;
+	}
+}
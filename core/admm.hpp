@@ -0,0 +1,88 @@
+#ifndef _CVX_ADMM_HPP_
+#define _CVX_ADMM_HPP_
+
+#include "checkpoint.hpp"
+#include "trace.hpp"
+
+// ADMM for the dual problem
+// min -b^y
+// s.t. A^T * y + s = c
+//		s >= 0
+// L = -b^T * y + x^T * (A^T*y+s-c)+t/2||A^T*y+s-c||_2^2
+// ADMM:
+// y+ = argmin_y{L}
+// (tAA^T+kI)y=b-A(x-t(c-s))
+// s+ = argmin_{ s >= 0 }{L}
+// s = -x/t +c -A^T*y
+// x+ = x+t(A^T*y + s -c)
+// Over-relaxation replaces A^T*y in the s- and x-updates by
+// alpha*A^T*y + (1-alpha)*(c-s_-), alpha in (0, 2)
+// Residual balancing multiplies t by penaltyFactor while ||A^T*y+s-c|| exceeds
+// balance * t*||A(s-s_-)|| and divides it in the opposite case.
+// AA^T = QLQ^T is eigendecomposed once before the first iteration, so every
+// y-update is two m x m products with Q and a new t is a diagonal rescale
+// (tL+kI)^-1 instead of a refactorization
+// The map (x, s) -> (x_+, s_+) is accelerated with type-II Anderson
+// acceleration (see anderson.hpp), restarted whenever t changes. Results and
+// checkpoints hold the plain (x, s, y) of the last accepted point, never an
+// extrapolated (x, s)
+// Batch mode runs K problems that share A side by side: the iterates are
+// n x K and m x K blocks, so every product with A or A^T is one pass over A
+// for all of them (dgemm instead of K dgemv), and the eigendecomposition of
+// AA^T serves every instance whatever its t
+
+namespace cvx
+{
+	struct AdmmOptions
+	{
+		// penalty, 0 picks penaltyScale * ||b|| / (||A||_2 * ||c||)
+		double_t t = 0;
+		double_t penaltyScale = 10;
+		// regularization of t * A * A^T, 0 picks 1e-9 * t * ||A||_2^2
+		double_t k = 0;
+		int32_t outerCount = 3000;
+		// A^T * y is at hand after every iteration, A * x costs one product, so
+		// the residuals are checked every checkInterval iterations (<= 0 never)
+		int32_t checkInterval = 10;
+		Tolerances tolerances;
+		// over-relaxation, 1 is plain ADMM
+		double_t alpha = 1;
+		// iterations before the first residual-balancing update of t, the
+		// interval doubles after every update (<= 0 keeps t fixed)
+		int32_t penaltyInterval = 10;
+		double_t balance = 10;
+		double_t penaltyFactor = 2;
+		// Anderson acceleration of (x, s) over this many past steps, 0 runs
+		// the plain iteration
+		int32_t andersonMemory = 10;
+		// periodic snapshots of the state for --resume, see checkpoint.hpp
+		CheckpointOptions checkpoint;
+		// printed lines and the in-memory iteration trace, see trace.hpp
+		TraceOptions trace;
+		// JSON report of the per-phase timers, see profile.hpp
+		std::string profile;
+	};
+
+	// start may carry x (n), s (n) and y (m), missing vectors start from zero; a
+	// resumed start also continues its iteration count, t (penalty) and the
+	// residual-balancing schedule
+	Result solve_admm(const Problem &problem, const AdmmOptions &options, const Result *start = nullptr);
+
+	// count LPs min c_k^T * x s.t. A * x = b_k, x >= 0 sharing the A of problem
+	struct Batch
+	{
+		int32_t count = 0;
+		// m x count column-major, column k is b_k; null repeats problem.b
+		const double_t *b = nullptr;
+		// n x count column-major, column k is c_k; null repeats problem.c
+		const double_t *c = nullptr;
+	};
+
+	// one Result per instance, in order. Every instance keeps its own t,
+	// residual balancing and Anderson history; an instance that meets the
+	// tolerances drops out of the block products. Starts from zero, the
+	// checkpoint options are not used.
+	std::vector<Result> solve_admm_batch(const Problem &problem, const Batch &batch, const AdmmOptions &options);
+}
+
+#endif /*!_CVX_ADMM_HPP_*/
@@ -0,0 +1,90 @@
+#include "alm.hpp"
+#include "kernels.hpp"
+#include "profile.hpp"
+#include "workspace.hpp"
+
+namespace cvx {
+
+	// estimate_norm approaches ||A||_2 from below and may stop early when the
+	// top singular values are close, so the step is taken for a norm this
+	// much larger to keep t <= 1 / L
+	const static double_t normMargin = 1.05;
+
+	Result solve_alm(const Problem &problem, const AlmOptions &options, const Result *start)
+	{
+		Profiler profiler(options.profile, "alm");
+		const int32_t m = problem.m;
+		const int32_t n = problem.n;
+		const double_t sigma = options.sigma;
+		double_t t = options.t;
+		if (t <= 0.0 && start != nullptr && start->penalty > 0.0)
+			t = start->penalty;
+		if (t <= 0.0) {
+			double_t norm = normMargin * estimate_norm(problem);
+			t = 1.0 / (sigma * norm * norm);
+		}
+
+		Workspace workspace;
+		double_t *x = workspace.vector(n);
+		double_t *y = workspace.vector(m);
+		double_t *projection = workspace.vector(n);
+		double_t *gradient = workspace.vector(m);
+		double_t *shadow = workspace.vector(n);
+		double_t *point = options.accelerated ? workspace.vector(m) : nullptr;
+		double_t *pointShadow = options.accelerated ? workspace.vector(n) : nullptr;
+
+		initial_iterate(start ? &start->x : nullptr, x, n);
+		initial_iterate(start ? &start->y : nullptr, y, m);
+
+		//||\nabla{L}|| is scaled like the primal residual
+		const double_t innerTolerance = options.innerTolerance * (1.0 + cblas_dnrm2(m, problem.b, 1));
+
+		//shadow = A^T * y, kept up to date by alm_inner
+		multiply_At(problem, 1.0, y, 0.0, shadow);
+
+		Trace trace(options.trace);
+		Checkpointer checkpointer(options.checkpoint, "alm", problem);
+		//the iterate handed to the checkpoint writer
+		auto snapshot = [&](Result state) {
+			state.x.assign(x, x + n);
+			state.y.assign(y, y + m);
+			state.penalty = t;
+			return state;
+		};
+
+		Result result;
+		const int32_t first = start ? start->iterations : 0;
+		result.iterations = first;
+		for (int32_t outer = first; outer < options.outerCount; ++outer) {
+			//update of y, one pass over A per inner iteration
+			if (options.accelerated)
+				alm_inner_accelerated(problem, x, sigma, t, options.innerCount, innerTolerance, y, projection, gradient, shadow, point, pointShadow);
+			else
+				alm_inner(problem, x, sigma, t, options.innerCount, innerTolerance, y, projection, gradient, shadow);
+			//x = projection
+			cblas_daxpby(n, 1.0, projection, 1, 0.0, x, 1);
+
+			result.primal = primal_objective(problem, x);
+			result.dual = dual_objective(problem, y);
+			result.iterations = outer + 1;
+
+			//gradient = A * x - b, shadow = A^T * y
+			result.residuals.primal = primal_infeasibility(problem, gradient);
+			result.residuals.dual = dual_infeasibility(problem, shadow);
+			result.residuals.gap = relative_gap(result.primal, result.dual);
+			trace.record(result.iterations, result.primal, result.dual, result.residuals);
+			if (options.tolerances.met(result.residuals)) {
+				result.converged = true;
+				break;
+			}
+			if (checkpointer.due(result.iterations))
+				checkpointer.save(snapshot(result));
+		}
+		trace.finish(result);
+
+		result = snapshot(std::move(result));
+		checkpointer.finish(result);
+		profiler.finish(result.iterations);
+		return result;
+	}
+}
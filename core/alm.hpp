@@ -0,0 +1,51 @@
+#ifndef _CVX_ALM_HPP_
+#define _CVX_ALM_HPP_
+
+#include "checkpoint.hpp"
+#include "trace.hpp"
+
+// Apply a gradient-type method to minimize augmented Lagrangian function
+// min -b^y
+// s.t. A^T * y + s = c
+//		s >= 0
+// L = -b^T * y + 1/(2*sigma)(||P_+(x-\sigma(c-A^T*y))||_2^2-||x||_s^2)
+// \nabla{L} = -b+AP_+(x-\sigma(c-A^T*y))
+// y_+ = y - t*\nabla{L}
+// or, accelerated, y_+ = w - t*\nabla{L}(w) at w = y + beta*(y - y_-) with the
+// FISTA beta, restarted (beta = 0) whenever \nabla{L}(w)^T(y_+ - y) > 0
+// x_+ = P_+(x-\sigma(c-A^T*y_+))
+// The inner gradient is A*x_+ - b and the fused inner loop leaves A^T*y_+
+// behind, so the residuals of (x_+, y_+) cost O(m + n) per outer iteration
+
+namespace cvx
+{
+	struct AlmOptions
+	{
+		double_t sigma = 0.01;
+		// inner step, 0 picks 1 / (sigma * ||A||_2^2), the inverse Lipschitz
+		// constant of \nabla{L}, from a power-iteration estimate of ||A||_2
+		// enlarged by 5%: the estimate is a lower bound and FISTA needs
+		// t <= 1 / L
+		double_t t = 0;
+		int32_t innerCount = 1000;
+		int32_t outerCount = 2000;
+		// FISTA inner loop with adaptive restart instead of plain gradient steps
+		bool accelerated = true;
+		// the inner loop ends early once ||\nabla{L}|| / (1 + ||b||) <= innerTolerance
+		double_t innerTolerance = 1e-5;
+		// checked after every outer iteration
+		Tolerances tolerances;
+		// periodic snapshots of the state for --resume, see checkpoint.hpp
+		CheckpointOptions checkpoint;
+		// printed lines and the in-memory iteration trace, see trace.hpp
+		TraceOptions trace;
+		// JSON report of the per-phase timers, see profile.hpp
+		std::string profile;
+	};
+
+	// start may carry x (n) and y (m), missing vectors start from zero; a
+	// resumed start also continues its iteration count and t (penalty)
+	Result solve_alm(const Problem &problem, const AlmOptions &options, const Result *start = nullptr);
+}
+
+#endif /*!_CVX_ALM_HPP_*/
@@ -0,0 +1,102 @@
+#include <algorithm>
+#include "anderson.hpp"
+#include "profile.hpp"
+
+namespace cvx {
+
+	Anderson::Anderson(int32_t size, int32_t tracked, int32_t memory, double_t safeguard) :
+		_size(size), _full(size + tracked), _memory(std::max(memory, 0)), _safeguard(safeguard),
+		_count(0), _head(0), _started(false), _extrapolated(false), _rejected(false), _previousNorm(0.0),
+		_df((size_t)_memory * size), _dg((size_t)_memory * _full), _gram((size_t)_memory * _memory),
+		_f(size), _previousF(size), _previousG(_full), _system((size_t)_memory * _memory), _gamma(_memory)
+	{
+	}
+
+	void Anderson::reset(void)
+	{
+		_count = 0;
+		_head = 0;
+		_started = false;
+		_extrapolated = false;
+		_rejected = false;
+	}
+
+	bool Anderson::step(const double_t *point, double_t *image)
+	{
+		_rejected = false;
+		if (_memory == 0)
+			return false;
+		//the history products and the combination of dG
+		CVX_PHASE(eANDERSON, 4.0 * _memory * _full, 8.0 * _memory * (_size + _full) + 32.0 * _full);
+
+		//f = T(v) - v
+		for (int32_t i = 0; i < _size; ++i) {
+			_f[i] = image[i] - point[i];
+		}
+		double_t norm = cblas_dnrm2(_size, _f.data(), 1);
+		if (_extrapolated && norm > _safeguard * _previousNorm) {
+			//the extrapolated point made things worse: drop it together with
+			//T(v) and continue from the plain image of the last accepted
+			//point. The history would build the same extrapolation again, so
+			//it goes as well; the previous f and T(v) stay, the next step
+			//pairs them with the image of T(v_-)
+			std::copy(_previousG.begin(), _previousG.end(), image);
+			_count = 0;
+			_head = 0;
+			_extrapolated = false;
+			_rejected = true;
+			return false;
+		}
+
+		if (_started) {
+			//slot head = (f - f_-, T(v) - T(v_-)), then its row of the Gram matrix
+			double_t *df = _df.data() + (size_t)_head * _size;
+			double_t *dg = _dg.data() + (size_t)_head * _full;
+			for (int32_t i = 0; i < _size; ++i) {
+				df[i] = _f[i] - _previousF[i];
+			}
+			for (int32_t i = 0; i < _full; ++i) {
+				dg[i] = image[i] - _previousG[i];
+			}
+			_count = std::min(_count + 1, _memory);
+			for (int32_t j = 0; j < _count; ++j) {
+				double_t product = cblas_ddot(_size, df, 1, _df.data() + (size_t)j * _size, 1);
+				_gram[(size_t)_head * _memory + j] = product;
+				_gram[(size_t)j * _memory + _head] = product;
+			}
+			_head = (_head + 1) % _memory;
+		}
+		std::copy(_f.begin(), _f.end(), _previousF.begin());
+		std::copy(image, image + _full, _previousG.begin());
+		_previousNorm = norm;
+		_started = true;
+		_extrapolated = false;
+		if (_count == 0)
+			return false;
+
+		//(dF^T * dF + lambda * I) * gamma = dF^T * f, lambda relative to the
+		//largest diagonal keeps nearly parallel differences solvable
+		double_t largest = 0.0;
+		for (int32_t i = 0; i < _count; ++i) {
+			largest = std::max(largest, _gram[(size_t)i * _memory + i]);
+		}
+		if (!(largest > 0.0))
+			return false;
+		for (int32_t i = 0; i < _count; ++i) {
+			for (int32_t j = 0; j < _count; ++j) {
+				_system[(size_t)i * _count + j] = _gram[(size_t)i * _memory + j];
+			}
+			_system[(size_t)i * _count + i] += 1e-10 * largest;
+			_gamma[i] = cblas_ddot(_size, _df.data() + (size_t)i * _size, 1, _f.data(), 1);
+		}
+		_solver.factor(_system.data(), _count);
+		_solver.solve(_gamma.data());
+
+		//image = T(v) - dG * gamma
+		for (int32_t j = 0; j < _count; ++j) {
+			cblas_daxpy(_full, -_gamma[j], _dg.data() + (size_t)j * _full, 1, image, 1);
+		}
+		_extrapolated = true;
+		return true;
+	}
+}
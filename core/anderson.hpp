@@ -0,0 +1,73 @@
+#ifndef _CVX_ANDERSON_HPP_
+#define _CVX_ANDERSON_HPP_
+
+#include <vector>
+#include "linear_solver.hpp"
+
+namespace cvx
+{
+	// Type-II Anderson acceleration of a fixed-point iteration v <- T(v).
+	// With f = T(v) - v and the last memory differences dF of f and dG of T(v)
+	// kept in a ring buffer, the next iterate is
+	//	T(v) - dG * gamma,	gamma = argmin ||f - dF * gamma||
+	// where gamma comes from the regularized normal equations, whose Gram
+	// matrix is updated one row per step: O(memory * size) per step.
+	// Entries after the first size ones (tracked) are not part of f but are
+	// combined with the same gamma, so quantities linear in v (such as A * v)
+	// stay consistent with the accelerated iterate.
+	// Safeguard: when ||f|| at an extrapolated point grows past safeguard
+	// times its value at the point before, the extrapolated point is
+	// rejected and the next iterate is the plain image T(v_-) of the last
+	// accepted point, so a bad extrapolation cannot compound. The history
+	// is dropped as well, since it would build the same extrapolation again;
+	// the next step pairs v_- with T(v_-) and starts a new one.
+	class Anderson
+	{
+	public:
+		Anderson(int32_t size, int32_t tracked, int32_t memory, double_t safeguard = 1.0);
+
+	public:
+		// point is v (size), image is T(v) (size + tracked) on entry and the
+		// next iterate on return; returns whether it was extrapolated (false
+		// as well when v was rejected)
+		bool step(const double_t *point, double_t *image);
+		// the last step returned an extrapolated iterate
+		bool extrapolated(void) const { return _extrapolated; }
+		// the last step rejected its point, image was replaced by T(v_-)
+		bool rejected(void) const { return _rejected; }
+		// T(v) of the last accepted point v (size + tracked), the plain
+		// iterate an extrapolated one was built from; valid after a step
+		const double_t *accepted(void) const { return _previousG.data(); }
+		// forget the history, e.g. after T itself changed
+		void reset(void);
+		int32_t memory(void) const { return _memory; }
+
+	private:
+		int32_t _size;
+		int32_t _full;
+		int32_t _memory;
+		double_t _safeguard;
+		// slots in use and the slot written next
+		int32_t _count;
+		int32_t _head;
+		bool _started;
+		// the last step returned an extrapolated iterate
+		bool _extrapolated;
+		bool _rejected;
+		double_t _previousNorm;
+		// memory x size and memory x full, one difference per row
+		std::vector<double_t> _df;
+		std::vector<double_t> _dg;
+		// memory x memory, _gram[i][j] = dF_i^T * dF_j
+		std::vector<double_t> _gram;
+		std::vector<double_t> _f;
+		std::vector<double_t> _previousF;
+		// T(v_-), the plain image of the last accepted point
+		std::vector<double_t> _previousG;
+		std::vector<double_t> _system;
+		std::vector<double_t> _gamma;
+		SpdSolver _solver;
+	};
+}
+
+#endif /*!_CVX_ANDERSON_HPP_*/
@@ -0,0 +1,370 @@
+#include <climits>
+#include <cstdio>
+#include <cstring>
+#include <sys/stat.h>
+#include "binary.hpp"
+#include "mapped_file.hpp"
+#include "sparse.hpp"
+
+namespace cvx {
+
+	static const char binaryMagic[8] = { 'C', 'V', 'X', 'L', 'P', 'B', 'I', 'N' };
+
+	static uint64_t align_up(uint64_t offset)
+	{
+		return (offset + binaryAlignment - 1) / binaryAlignment * binaryAlignment;
+	}
+
+	// offsets of the three CSR arrays
+	struct CsrSections
+	{
+		uint64_t rowPtr;
+		uint64_t colIdx;
+		uint64_t values;
+		uint64_t end;
+	};
+
+	// row pointers are int32 up to version 2
+	static uint64_t row_ptr_width(uint32_t version)
+	{
+		return version <= 2 ? sizeof(int32_t) : sizeof(int64_t);
+	}
+
+	// for the headers written here; map_problem_binary checks a header it
+	// reads array by array instead
+	static CsrSections csr_sections(uint64_t offsetA, uint64_t m, uint64_t nnz, uint32_t version)
+	{
+		CsrSections sections;
+		sections.rowPtr = offsetA;
+		sections.colIdx = align_up(sections.rowPtr + (m + 1) * row_ptr_width(version));
+		sections.values = align_up(sections.colIdx + nnz * sizeof(int32_t));
+		sections.end = sections.values + nnz * sizeof(double_t);
+		return sections;
+	}
+
+	// whether count items of width bytes starting at offset end within size
+	// bytes; divides instead of multiplying, so a corrupt header cannot wrap
+	static bool section_fits(uint64_t offset, uint64_t count, uint64_t width, uint64_t size)
+	{
+		return offset <= size && count <= (size - offset) / width;
+	}
+
+	// version 2 row pointer widened to int64, with the mapping it belongs to
+	struct WidenedRowPtr
+	{
+		std::shared_ptr<MappedFile> mapping;
+		std::vector<int64_t> rowPtr;
+	};
+
+	bool is_problem_binary(const std::string &path)
+	{
+		struct stat info;
+		if (stat(path.c_str(), &info) != 0 || !S_ISREG(info.st_mode))
+			return false;
+
+		FILE *file = fopen(path.c_str(), "rb");
+		if (file == nullptr)
+			return false;
+		char magic[8];
+		bool match = fread(magic, 1, sizeof(magic), file) == sizeof(magic) && memcmp(magic, binaryMagic, sizeof(magic)) == 0;
+		fclose(file);
+		return match;
+	}
+
+	Problem map_problem_binary(const std::string &path)
+	{
+		std::shared_ptr<MappedFile> mapping = std::make_shared<MappedFile>(path, true);
+		size_t size = mapping->size();
+		if (size < sizeof(BinaryHeader))
+			throw Error(std::string("Truncated binary problem ").append(path));
+
+		const BinaryHeader *header = (const BinaryHeader*)mapping->data();
+		if (memcmp(header->magic, binaryMagic, sizeof(binaryMagic)) != 0)
+			throw Error(path + " is not a binary problem");
+		if (header->version < 1 || header->version > binaryVersion)
+			throw Error(path + " has unsupported version " + std::to_string(header->version));
+		if (header->layout != eROW_MAJOR && header->layout != eCOL_MAJOR && header->layout != eCSR)
+			throw Error(path + " has unknown layout " + std::to_string(header->layout));
+
+		//sizes first, then every section against the file with checked
+		//arithmetic, so no product or end below can wrap
+		uint64_t m = header->m;
+		uint64_t n = header->n;
+		if (m > INT32_MAX || n > INT32_MAX)
+			throw Error(path + " has dimensions beyond 2^31 - 1");
+		if (header->layout == eCSR && header->nnz > m * n)
+			throw Error(path + " has more nonzeros than entries");
+		bool fits = header->offsetA % binaryAlignment == 0 && header->offsetB % binaryAlignment == 0 && header->offsetC % binaryAlignment == 0
+			&& section_fits(header->offsetB, m, sizeof(double_t), size)
+			&& section_fits(header->offsetC, n, sizeof(double_t), size);
+		CsrSections sections = {};
+		if (fits && header->layout == eCSR) {
+			//each array starts past the end of the previous one, which fits
+			const uint64_t nnz = header->nnz;
+			sections.rowPtr = header->offsetA;
+			fits = section_fits(sections.rowPtr, m + 1, row_ptr_width(header->version), size);
+			if (fits) {
+				sections.colIdx = align_up(sections.rowPtr + (m + 1) * row_ptr_width(header->version));
+				fits = section_fits(sections.colIdx, nnz, sizeof(int32_t), size);
+			}
+			if (fits) {
+				sections.values = align_up(sections.colIdx + nnz * sizeof(int32_t));
+				fits = section_fits(sections.values, nnz, sizeof(double_t), size);
+			}
+		}
+		else if (fits) {
+			fits = section_fits(header->offsetA, m * n, sizeof(double_t), size);
+		}
+		if (!fits)
+			throw Error(path + " has corrupted section offsets");
+
+		char *base = mapping->data();
+		Problem problem;
+		problem.m = (int32_t)m;
+		problem.n = (int32_t)n;
+		problem.layout = (Layout)header->layout;
+		problem.b = (double_t*)(base + header->offsetB);
+		problem.c = (double_t*)(base + header->offsetC);
+		problem.storage = mapping;
+
+		if (problem.is_sparse()) {
+			const int64_t *rowPtr = (const int64_t*)(base + sections.rowPtr);
+			std::shared_ptr<void> storage = mapping;
+			if (header->version <= 2) {
+				//widen the int32 row pointer, the mapping stays alive with it
+				const int32_t *narrow = (const int32_t*)(base + sections.rowPtr);
+				std::shared_ptr<WidenedRowPtr> widened = std::make_shared<WidenedRowPtr>();
+				widened->mapping = mapping;
+				widened->rowPtr.assign(narrow, narrow + m + 1);
+				rowPtr = widened->rowPtr.data();
+				storage = widened;
+			}
+			if (rowPtr[0] != 0 || (uint64_t)rowPtr[m] != header->nnz)
+				throw Error(path + " has a corrupted sparse row pointer");
+			for (uint64_t i = 0; i < m; ++i) {
+				if (rowPtr[i + 1] < rowPtr[i])
+					throw Error(path + " has a corrupted sparse row pointer");
+			}
+			problem.sparse = std::make_shared<SparseMatrix>(problem.m, problem.n, rowPtr,
+				(const int32_t*)(base + sections.colIdx), (const double_t*)(base + sections.values), storage);
+		}
+		else {
+			problem.A = (double_t*)(base + header->offsetA);
+			mapping->prefetch(header->offsetA, m * n * sizeof(double_t));
+		}
+		return problem;
+	}
+
+	static BinaryHeader make_header(uint64_t m, uint64_t n, Layout layout, uint64_t nnz)
+	{
+		BinaryHeader header;
+		memset(&header, 0, sizeof(header));
+		memcpy(header.magic, binaryMagic, sizeof(binaryMagic));
+		header.version = layout == eCSR ? binaryVersion : 1;
+		header.layout = layout;
+		header.m = m;
+		header.n = n;
+		header.offsetA = align_up(sizeof(BinaryHeader));
+		uint64_t endA = header.offsetA + m * n * sizeof(double_t);
+		if (layout == eCSR) {
+			header.nnz = nnz;
+			endA = csr_sections(header.offsetA, m, nnz, header.version).end;
+		}
+		header.offsetB = align_up(endA);
+		header.offsetC = align_up(header.offsetB + m * sizeof(double_t));
+		return header;
+	}
+
+	static void write_at(FILE *file, uint64_t offset, const void *data, size_t bytes)
+	{
+		static const char zeros[binaryAlignment] = {};
+		long position = ftell(file);
+		if (fwrite(zeros, 1, offset - position, file) != offset - position || fwrite(data, 1, bytes, file) != bytes)
+			throw Error("Failed to write binary problem");
+	}
+
+	static void write_dense(FILE *file, const Problem &problem, const BinaryHeader &header, Layout layout)
+	{
+		const uint64_t m = problem.m;
+		const uint64_t n = problem.n;
+
+		if (layout == problem.layout) {
+			write_at(file, header.offsetA, problem.A, m * n * sizeof(double_t));
+			return;
+		}
+
+		const uint64_t lines = layout == eROW_MAJOR ? m : n;
+		const uint64_t length = layout == eROW_MAJOR ? n : m;
+		std::vector<double_t> line(length);
+		write_at(file, header.offsetA, nullptr, 0);
+		for (uint64_t i = 0; i < lines; ++i) {
+			if (problem.is_sparse()) {
+				//expand one CSR row
+				const SparseMatrix &A = *problem.sparse;
+				std::fill(line.begin(), line.end(), 0.0);
+				for (int64_t p = A.row_ptr()[i]; p < A.row_ptr()[i + 1]; ++p) {
+					line[A.col_idx()[p]] = A.values()[p];
+				}
+			}
+			else {
+				//transpose one output line
+				const uint64_t stride = problem.lda();
+				for (uint64_t j = 0; j < length; ++j) {
+					line[j] = problem.A[j*stride + i];
+				}
+			}
+			if (fwrite(line.data(), sizeof(double_t), length, file) != length)
+				throw Error("Failed to write binary problem");
+		}
+	}
+
+	void write_problem_binary(const Problem &problem, const std::string &path, Layout layout)
+	{
+		if (layout == eCSR && !problem.is_sparse())
+			return write_problem_binary(make_sparse(problem), path, layout);
+		if (problem.is_sparse() && layout == eCOL_MAJOR)
+			throw Error("a sparse problem can only be written as csr or row-major");
+
+		const uint64_t m = problem.m;
+		const uint64_t n = problem.n;
+		BinaryHeader header = make_header(m, n, layout, layout == eCSR ? problem.sparse->nnz() : 0);
+
+		FILE *file = fopen(path.c_str(), "wb");
+		if (file == nullptr)
+			throw Error(std::string("Failed to create ").append(path));
+
+		try {
+			write_at(file, 0, &header, sizeof(header));
+			if (layout == eCSR) {
+				const SparseMatrix &A = *problem.sparse;
+				CsrSections sections = csr_sections(header.offsetA, m, header.nnz, header.version);
+				write_at(file, sections.rowPtr, A.row_ptr(), (m + 1) * sizeof(int64_t));
+				write_at(file, sections.colIdx, A.col_idx(), header.nnz * sizeof(int32_t));
+				write_at(file, sections.values, A.values(), header.nnz * sizeof(double_t));
+			}
+			else {
+				write_dense(file, problem, header, layout);
+			}
+			write_at(file, header.offsetB, problem.b, m * sizeof(double_t));
+			write_at(file, header.offsetC, problem.c, n * sizeof(double_t));
+		}
+		catch (...) {
+			fclose(file);
+			throw;
+		}
+		if (fclose(file) != 0)
+			throw Error(std::string("Failed to write ").append(path));
+	}
+
+	// positions file at offset, a gap past the end reads back as zeros
+	static void seek_to(FILE *file, uint64_t offset)
+	{
+		if (fseeko(file, (off_t)offset, SEEK_SET) != 0)
+			throw Error("Failed to seek in binary problem");
+	}
+
+	static void write_all(FILE *file, const void *data, size_t count, size_t size)
+	{
+		if (fwrite(data, size, count, file) != count)
+			throw Error("Failed to write binary problem");
+	}
+
+	BinaryWriter::BinaryWriter(const std::string &path, int32_t m, int32_t n, int64_t nnz) :
+		_path(path), _file(nullptr), _values(nullptr), _rows(0)
+	{
+		if (m <= 0 || n <= 0)
+			throw Error("binary problem dimensions must be positive");
+		_header = make_header(m, n, nnz < 0 ? eROW_MAJOR : eCSR, nnz < 0 ? 0 : nnz);
+
+		_file = fopen(path.c_str(), "wb");
+		if (_file == nullptr)
+			throw Error(std::string("Failed to create ").append(path));
+		try {
+			write_all(_file, &_header, 1, sizeof(_header));
+			if (nnz >= 0) {
+				CsrSections sections = csr_sections(_header.offsetA, m, nnz, _header.version);
+				_values = fopen(path.c_str(), "r+b");
+				if (_values == nullptr)
+					throw Error(std::string("Failed to open ").append(path));
+				seek_to(_values, sections.values);
+				//rowPtr is written by finish()
+				seek_to(_file, sections.colIdx);
+				_rowPtr.reserve((size_t)m + 1);
+				_rowPtr.push_back(0);
+			}
+			else {
+				seek_to(_file, _header.offsetA);
+			}
+		}
+		catch (...) {
+			discard();
+			throw;
+		}
+	}
+
+	BinaryWriter::~BinaryWriter(void)
+	{
+		discard();
+	}
+
+	void BinaryWriter::discard(void)
+	{
+		if (_values != nullptr)
+			fclose(_values);
+		if (_file != nullptr) {
+			fclose(_file);
+			remove(_path.c_str());
+		}
+		_values = _file = nullptr;
+	}
+
+	void BinaryWriter::dense_row(const double_t *row)
+	{
+		if (_header.layout != eROW_MAJOR || _rows == (int32_t)_header.m)
+			throw Error("unexpected dense row for " + _path);
+		write_all(_file, row, _header.n, sizeof(double_t));
+		++_rows;
+	}
+
+	void BinaryWriter::sparse_row(const int32_t *columns, const double_t *values, int32_t count)
+	{
+		if (_header.layout != eCSR) {
+			//expand into a dense row
+			std::vector<double_t> row(_header.n, 0.0);
+			for (int32_t k = 0; k < count; ++k) {
+				row[columns[k]] = values[k];
+			}
+			return dense_row(row.data());
+		}
+		if (_rows == (int32_t)_header.m || (uint64_t)_rowPtr.back() + count > _header.nnz)
+			throw Error("more nonzeros than announced for " + _path);
+		write_all(_file, columns, count, sizeof(int32_t));
+		write_all(_values, values, count, sizeof(double_t));
+		_rowPtr.push_back(_rowPtr.back() + count);
+		++_rows;
+	}
+
+	void BinaryWriter::finish(const double_t *b, const double_t *c)
+	{
+		if (_rows != (int32_t)_header.m || (_header.layout == eCSR && (uint64_t)_rowPtr.back() != _header.nnz))
+			throw Error("incomplete matrix for " + _path);
+		if (_values != nullptr) {
+			FILE *values = _values;
+			_values = nullptr;
+			if (fclose(values) != 0)
+				throw Error(std::string("Failed to write ").append(_path));
+			seek_to(_file, _header.offsetA);
+			write_all(_file, _rowPtr.data(), _rowPtr.size(), sizeof(int64_t));
+		}
+		seek_to(_file, _header.offsetB);
+		write_all(_file, b, _header.m, sizeof(double_t));
+		seek_to(_file, _header.offsetC);
+		write_all(_file, c, _header.n, sizeof(double_t));
+		FILE *file = _file;
+		_file = nullptr;
+		if (fclose(file) != 0) {
+			remove(_path.c_str());
+			throw Error(std::string("Failed to write ").append(_path));
+		}
+	}
+}
@@ -0,0 +1,84 @@
+#ifndef _CVX_BINARY_HPP_
+#define _CVX_BINARY_HPP_
+
+#include <cstdio>
+#include "problem.hpp"
+
+// Binary problem container, little-endian, every section 64-byte aligned
+//
+//	offset 0	BinaryHeader (64 bytes)
+//	offsetA		A, m * n doubles, row- or column-major as given by layout
+//	offsetB		b, m doubles
+//	offsetC		c, n doubles
+//
+// A sparse A (layout eCSR) is three arrays starting at offsetA, each on the
+// next 64 byte boundary: rowPtr (m + 1 int64, int32 in version 2 files),
+// colIdx (nnz int32) and values (nnz doubles).
+//
+// Mapping the file gives the engines A, b and c in place, so loading a problem
+// costs page faults only.
+
+namespace cvx
+{
+	const static uint32_t binaryVersion = 3;
+	const static uint64_t binaryAlignment = 64;
+
+	struct BinaryHeader
+	{
+		char magic[8];
+		uint32_t version;
+		uint32_t layout;
+		uint64_t m;
+		uint64_t n;
+		uint64_t offsetA;
+		uint64_t offsetB;
+		uint64_t offsetC;
+		// nonzeros of A for eCSR, otherwise 0
+		uint64_t nnz;
+	};
+	static_assert(sizeof(BinaryHeader) == 64, "binary header must fill one 64 byte block");
+
+	// true when path is a regular file starting with the binary magic
+	bool is_problem_binary(const std::string &path);
+	// maps the file read/write private, A, b and c point into the mapping
+	Problem map_problem_binary(const std::string &path);
+	// a dense problem can be written in any layout, a sparse one as eCSR or
+	// eROW_MAJOR
+	void write_problem_binary(const Problem &problem, const std::string &path, Layout layout = eROW_MAJOR);
+
+	// Writes a problem without holding A: the rows of A in order, then b and c
+	// with finish(). A CSR file needs its nonzero count up front, the values
+	// section follows the column indices. The file is removed if the writer
+	// is destroyed before finish().
+	class BinaryWriter
+	{
+	public:
+		// nnz < 0 writes a dense row-major A, otherwise eCSR
+		BinaryWriter(const std::string &path, int32_t m, int32_t n, int64_t nnz = -1);
+		~BinaryWriter(void);
+		BinaryWriter(const BinaryWriter &) = delete;
+		BinaryWriter &operator=(const BinaryWriter &) = delete;
+
+	public:
+		// the next row, n entries with the zeros
+		void dense_row(const double_t *row);
+		// the next row given by its nonzeros in ascending columns
+		void sparse_row(const int32_t *columns, const double_t *values, int32_t count);
+		void finish(const double_t *b, const double_t *c);
+
+	private:
+		// closes and removes an unfinished file
+		void discard(void);
+
+	private:
+		std::string _path;
+		BinaryHeader _header;
+		FILE *_file;
+		// second handle on the same file, positioned in the values section
+		FILE *_values;
+		std::vector<int64_t> _rowPtr;
+		int32_t _rows;
+	};
+}
+
+#endif /*!_CVX_BINARY_HPP_*/
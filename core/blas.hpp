@@ -0,0 +1,81 @@
+#ifndef _CVX_BLAS_HPP_
+#define _CVX_BLAS_HPP_
+
+// BLAS/LAPACK backend.
+// With CVX_USE_MKL the solvers talk to MKL directly. Otherwise any CBLAS that
+// provides cblas_daxpby (OpenBLAS) is used together with the Fortran LAPACK
+// symbols, and mkl_malloc/mkl_free are mapped onto aligned_alloc so the solver
+// code is written once against the MKL spelling.
+// blas_int is the integer of the BLAS/LAPACK interface: MKL_INT, 64-bit with
+// CVX_MKL_ILP64, or OpenBLAS's blasint, 64-bit in its INTERFACE64 builds.
+// Dimensions stay int32 either way, the wider integer matters for the m x m
+// systems once m * m passes 2^31 and for CSR with more than 2^31 nonzeros.
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+
+#ifdef CVX_USE_MKL
+
+#include <mkl.h>
+
+typedef MKL_INT blas_int;
+
+#else
+
+#include <cblas.h>
+
+typedef blasint blas_int;
+
+extern "C" {
+	void dgetrf_(const blas_int* m, const blas_int* n, double* a, const blas_int* lda, blas_int* ipiv, blas_int* info);
+	void dgetri_(const blas_int* n, double* a, const blas_int* lda, const blas_int* ipiv, double* work, const blas_int* lwork, blas_int* info);
+	void dpotrf_(const char* uplo, const blas_int* n, double* a, const blas_int* lda, blas_int* info);
+	void dpotrs_(const char* uplo, const blas_int* n, const blas_int* nrhs, const double* a, const blas_int* lda, double* b, const blas_int* ldb, blas_int* info);
+	void dsytrf_(const char* uplo, const blas_int* n, double* a, const blas_int* lda, blas_int* ipiv, double* work, const blas_int* lwork, blas_int* info);
+	void dsytrs_(const char* uplo, const blas_int* n, const blas_int* nrhs, const double* a, const blas_int* lda, const blas_int* ipiv, double* b, const blas_int* ldb, blas_int* info);
+	void dsyev_(const char* jobz, const char* uplo, const blas_int* n, double* a, const blas_int* lda, double* w, double* work, const blas_int* lwork, blas_int* info);
+}
+
+inline void dgetrf(const blas_int* m, const blas_int* n, double* a, const blas_int* lda, blas_int* ipiv, blas_int* info) {
+	dgetrf_(m, n, a, lda, ipiv, info);
+}
+
+inline void dgetri(const blas_int* n, double* a, const blas_int* lda, const blas_int* ipiv, double* work, const blas_int* lwork, blas_int* info) {
+	dgetri_(n, a, lda, ipiv, work, lwork, info);
+}
+
+inline void dpotrf(const char* uplo, const blas_int* n, double* a, const blas_int* lda, blas_int* info) {
+	dpotrf_(uplo, n, a, lda, info);
+}
+
+inline void dpotrs(const char* uplo, const blas_int* n, const blas_int* nrhs, const double* a, const blas_int* lda, double* b, const blas_int* ldb, blas_int* info) {
+	dpotrs_(uplo, n, nrhs, a, lda, b, ldb, info);
+}
+
+inline void dsytrf(const char* uplo, const blas_int* n, double* a, const blas_int* lda, blas_int* ipiv, double* work, const blas_int* lwork, blas_int* info) {
+	dsytrf_(uplo, n, a, lda, ipiv, work, lwork, info);
+}
+
+inline void dsytrs(const char* uplo, const blas_int* n, const blas_int* nrhs, const double* a, const blas_int* lda, const blas_int* ipiv, double* b, const blas_int* ldb, blas_int* info) {
+	dsytrs_(uplo, n, nrhs, a, lda, ipiv, b, ldb, info);
+}
+
+inline void dsyev(const char* jobz, const char* uplo, const blas_int* n, double* a, const blas_int* lda, double* w, double* work, const blas_int* lwork, blas_int* info) {
+	dsyev_(jobz, uplo, n, a, lda, w, work, lwork, info);
+}
+
+inline void* mkl_malloc(size_t size, int alignment) {
+	//aligned_alloc requires the size to be a multiple of the alignment
+	size_t rounded = (size + alignment - 1) / alignment * alignment;
+	return std::aligned_alloc(alignment, rounded == 0 ? alignment : rounded);
+}
+
+inline void mkl_free(void* ptr) {
+	std::free(ptr);
+}
+
+#endif
+
+#endif /*!_CVX_BLAS_HPP_*/
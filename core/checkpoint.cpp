@@ -0,0 +1,217 @@
+#include <cstdio>
+#include <cstring>
+#include <unistd.h>
+#include "checkpoint.hpp"
+#include "profile.hpp"
+#include "sparse.hpp"
+
+namespace cvx {
+
+	static const char checkpointMagic[8] = { 'C', 'V', 'X', 'S', 'T', 'A', 'T', 'E' };
+
+	const static uint64_t fnvBasis = 0xCBF29CE484222325ull;
+
+	static uint64_t fnv1a(uint64_t hash, const void *data, size_t size)
+	{
+		const unsigned char *bytes = reinterpret_cast<const unsigned char *>(data);
+		for (size_t i = 0; i < size; ++i) {
+			hash = (hash ^ bytes[i]) * 0x100000001B3ull;
+		}
+		return hash;
+	}
+
+	//a nonzero of A, its position included so that moving it changes the hash
+	static uint64_t fnv1a_entry(uint64_t hash, int32_t row, int32_t column, double_t value)
+	{
+		hash = fnv1a(hash, &row, sizeof(row));
+		hash = fnv1a(hash, &column, sizeof(column));
+		return fnv1a(hash, &value, sizeof(value));
+	}
+
+	ProblemFingerprint fingerprint_of(const Problem &problem)
+	{
+		//the nonzeros of A in row order, whatever the layout, then b and c
+		ProblemFingerprint fingerprint;
+		uint64_t hash = fnvBasis;
+		if (problem.is_sparse()) {
+			const int64_t *rowPtr = problem.sparse->row_ptr();
+			const int32_t *colIdx = problem.sparse->col_idx();
+			const double_t *values = problem.sparse->values();
+			for (int32_t i = 0; i < problem.m; ++i) {
+				for (int64_t p = rowPtr[i]; p < rowPtr[i + 1]; ++p) {
+					if (values[p] == 0.0)
+						continue;
+					++fingerprint.nnz;
+					hash = fnv1a_entry(hash, i, colIdx[p], values[p]);
+				}
+			}
+		}
+		else {
+			const size_t rowStride = problem.layout == eROW_MAJOR ? problem.n : 1;
+			const size_t columnStride = problem.layout == eROW_MAJOR ? 1 : problem.m;
+			for (int32_t i = 0; i < problem.m; ++i) {
+				for (int32_t j = 0; j < problem.n; ++j) {
+					double_t value = problem.A[i * rowStride + j * columnStride];
+					if (value == 0.0)
+						continue;
+					++fingerprint.nnz;
+					hash = fnv1a_entry(hash, i, j, value);
+				}
+			}
+		}
+		hash = fnv1a(hash, problem.b, sizeof(double_t) * problem.m);
+		hash = fnv1a(hash, problem.c, sizeof(double_t) * problem.n);
+		fingerprint.hash = hash == 0 ? 1 : hash;
+		return fingerprint;
+	}
+
+	void write_checkpoint(const std::string &path, const Checkpoint &checkpoint)
+	{
+		const Result &state = checkpoint.state;
+		const std::vector<double_t> *vectors[4] = { &state.x, &state.y, &state.s, &state.z };
+		if (checkpoint.engine.size() >= sizeof(CheckpointHeader::engine))
+			throw Error("engine name too long for a checkpoint: " + checkpoint.engine);
+
+		CheckpointHeader header;
+		memset(&header, 0, sizeof(header));
+		memcpy(header.magic, checkpointMagic, sizeof(checkpointMagic));
+		header.version = checkpointVersion;
+		header.flags = state.converged ? 1 : 0;
+		memcpy(header.engine, checkpoint.engine.data(), checkpoint.engine.size());
+		header.m = checkpoint.m;
+		header.n = checkpoint.n;
+		header.iterations = state.iterations;
+		header.penalty = state.penalty;
+		header.primal = state.primal;
+		header.dual = state.dual;
+		for (int32_t i = 0; i < 4; ++i) {
+			header.sizes[i] = vectors[i]->size();
+		}
+		header.nnz = checkpoint.fingerprint.nnz;
+		header.fingerprint = checkpoint.fingerprint.hash;
+
+		std::string temporary = path + ".tmp";
+		FILE *file = fopen(temporary.c_str(), "wb");
+		if (file == nullptr)
+			throw Error(std::string("Failed to create ").append(temporary));
+		bool written = fwrite(&header, sizeof(header), 1, file) == 1;
+		for (int32_t i = 0; i < 4 && written; ++i) {
+			written = fwrite(vectors[i]->data(), sizeof(double_t), vectors[i]->size(), file) == vectors[i]->size();
+		}
+		//the data has to be on disk before the rename can be
+		written = written && fflush(file) == 0 && fsync(fileno(file)) == 0;
+		if (fclose(file) != 0 || !written) {
+			remove(temporary.c_str());
+			throw Error(std::string("Failed to write ").append(temporary));
+		}
+		if (rename(temporary.c_str(), path.c_str()) != 0)
+			throw Error("Failed to rename " + temporary + " to " + path);
+	}
+
+	Checkpoint read_checkpoint(const std::string &path)
+	{
+		FILE *file = fopen(path.c_str(), "rb");
+		if (file == nullptr)
+			throw Error(std::string("Failed to open ").append(path));
+
+		Checkpoint checkpoint;
+		try {
+			CheckpointHeader header;
+			if (fread(&header, sizeof(header), 1, file) != 1)
+				throw Error(std::string("Truncated checkpoint ").append(path));
+			if (memcmp(header.magic, checkpointMagic, sizeof(checkpointMagic)) != 0)
+				throw Error(path + " is not a checkpoint");
+			if (header.version < 1 || header.version > checkpointVersion)
+				throw Error(path + ": unsupported checkpoint version " + std::to_string(header.version));
+			if (header.m > INT32_MAX || header.n > INT32_MAX || header.iterations > INT32_MAX)
+				throw Error(path + ": checkpoint header out of range");
+
+			Result &state = checkpoint.state;
+			checkpoint.engine.assign(header.engine, strnlen(header.engine, sizeof(header.engine)));
+			checkpoint.m = (int32_t)header.m;
+			checkpoint.n = (int32_t)header.n;
+			//version 2 hashed only b and c, its fingerprint compares with nothing
+			if (header.version == checkpointVersion) {
+				checkpoint.fingerprint.nnz = header.nnz;
+				checkpoint.fingerprint.hash = header.fingerprint;
+			}
+			state.iterations = (int32_t)header.iterations;
+			state.penalty = header.penalty;
+			state.primal = header.primal;
+			state.dual = header.dual;
+			state.converged = (header.flags & 1) != 0;
+			std::vector<double_t> *vectors[4] = { &state.x, &state.y, &state.s, &state.z };
+			for (int32_t i = 0; i < 4; ++i) {
+				if (header.sizes[i] > header.m + header.n)
+					throw Error(path + ": checkpoint vector out of range");
+				vectors[i]->resize(header.sizes[i]);
+				if (fread(vectors[i]->data(), sizeof(double_t), vectors[i]->size(), file) != vectors[i]->size())
+					throw Error(std::string("Truncated checkpoint ").append(path));
+			}
+		}
+		catch (...) {
+			fclose(file);
+			throw;
+		}
+		fclose(file);
+		return checkpoint;
+	}
+
+	Checkpointer::Checkpointer(const CheckpointOptions &options, const std::string &engine, const Problem &problem) :
+		_options(options)
+	{
+		_checkpoint.engine = engine;
+		_checkpoint.m = problem.m;
+		_checkpoint.n = problem.n;
+		if (enabled())
+			_checkpoint.fingerprint = fingerprint_of(problem);
+	}
+
+	Checkpointer::~Checkpointer(void)
+	{
+		//a failed background write must not escape the destructor
+		if (_pending.valid()) {
+			try {
+				_pending.get();
+			}
+			catch (...) {
+			}
+		}
+	}
+
+	bool Checkpointer::due(int32_t iterations) const
+	{
+		return enabled() && _options.interval > 0 && iterations % _options.interval == 0;
+	}
+
+	void Checkpointer::save(Result state)
+	{
+		if (!enabled())
+			return;
+		//the copy handed over, the write runs on its own thread
+		CVX_PHASE(eCHECKPOINT, 0.0, 8.0 * (state.x.size() + state.y.size() + state.s.size() + state.z.size()));
+		if (_pending.valid()) {
+			if (_pending.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+				return;
+			//rethrows a failed write
+			_pending.get();
+		}
+		Checkpoint checkpoint = _checkpoint;
+		checkpoint.state = std::move(state);
+		std::string path = _options.path;
+		_pending = std::async(std::launch::async, [path, checkpoint]() {
+			write_checkpoint(path, checkpoint);
+		});
+	}
+
+	void Checkpointer::finish(Result state)
+	{
+		if (!enabled())
+			return;
+		CVX_PHASE(eCHECKPOINT, 0.0, 8.0 * (state.x.size() + state.y.size() + state.s.size() + state.z.size()));
+		if (_pending.valid())
+			_pending.get();
+		_checkpoint.state = std::move(state);
+		write_checkpoint(_options.path, _checkpoint);
+	}
+}
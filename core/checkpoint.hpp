@@ -0,0 +1,112 @@
+#ifndef _CVX_CHECKPOINT_HPP_
+#define _CVX_CHECKPOINT_HPP_
+
+#include <future>
+#include "problem.hpp"
+
+// Engine state snapshot, little-endian
+//
+//	offset 0	CheckpointHeader (128 bytes)
+//	then x, y, s and z back to back, sizes[0..3] doubles each
+//
+// The state is a Result: the iterates, the iteration counter and the
+// penalty/step the engine was running with. Cached factorizations are not
+// stored, a resumed engine rebuilds them before its first iteration.
+// The header also fingerprints the problem (the count of nonzeros of A and a
+// hash of them, positions included, and of b and c) so that a resume on
+// another problem of the same shape is refused. Version 1 files carry no
+// fingerprint and the version 2 one covered b and c only; both still load,
+// without a fingerprint.
+
+namespace cvx
+{
+	const static uint32_t checkpointVersion = 3;
+
+	// Cheap identity of a problem, one pass over the values of A, b and c
+	struct ProblemFingerprint
+	{
+		uint64_t nnz = 0;
+		// FNV-1a over (row, column, value) of every nonzero of A in row
+		// order, then the bytes of b and c; 0 for an unknown problem
+		uint64_t hash = 0;
+
+		bool known(void) const { return hash != 0; }
+		bool operator==(const ProblemFingerprint &other) const { return nnz == other.nnz && hash == other.hash; }
+		bool operator!=(const ProblemFingerprint &other) const { return !(*this == other); }
+	};
+
+	// zeros are skipped wherever they are stored, so the dense (either
+	// layout) and CSR copies of a problem share a fingerprint
+	ProblemFingerprint fingerprint_of(const Problem &problem);
+
+	struct CheckpointHeader
+	{
+		char magic[8];
+		uint32_t version;
+		// bit 0: converged
+		uint32_t flags;
+		char engine[16];
+		uint64_t m;
+		uint64_t n;
+		uint64_t iterations;
+		double_t penalty;
+		double_t primal;
+		double_t dual;
+		uint64_t sizes[4];
+		// ProblemFingerprint, zero in version 1, b and c only in version 2
+		uint64_t nnz;
+		uint64_t fingerprint;
+	};
+	static_assert(sizeof(CheckpointHeader) == 128, "checkpoint header must be 128 bytes");
+
+	struct Checkpoint
+	{
+		// "alm", "ssn", "admm" or "drs"
+		std::string engine;
+		int32_t m = 0;
+		int32_t n = 0;
+		ProblemFingerprint fingerprint;
+		Result state;
+	};
+
+	// written to path + ".tmp", synced and renamed over path, so a crash
+	// mid-write leaves the previous checkpoint intact
+	void write_checkpoint(const std::string &path, const Checkpoint &checkpoint);
+	Checkpoint read_checkpoint(const std::string &path);
+
+	struct CheckpointOptions
+	{
+		// empty disables checkpointing
+		std::string path;
+		// iterations between checkpoints, the final state is always written
+		int32_t interval = 100;
+	};
+
+	// Periodic checkpoints of one solve, written on a background thread so the
+	// engine only pays for copying its state. A checkpoint that comes due while
+	// the previous one is still being written is skipped.
+	class Checkpointer
+	{
+	public:
+		Checkpointer(const CheckpointOptions &options, const std::string &engine, const Problem &problem);
+		~Checkpointer(void);
+		Checkpointer(const Checkpointer &) = delete;
+		Checkpointer &operator=(const Checkpointer &) = delete;
+
+	public:
+		bool enabled(void) const { return !_options.path.empty(); }
+		// a checkpoint is due after this many iterations
+		bool due(int32_t iterations) const;
+		// state is moved to the writer thread
+		void save(Result state);
+		// waits for the writer, then writes state synchronously
+		void finish(Result state);
+
+	private:
+		CheckpointOptions _options;
+		Checkpoint _checkpoint;
+		std::future<void> _pending;
+	};
+}
+
+#endif /*!_CVX_CHECKPOINT_HPP_*/
@@ -0,0 +1,173 @@
+#include <iostream>
+#include "cli.hpp"
+#include "pool.hpp"
+
+namespace cvx {
+
+	// the start vectors an engine reads, the others it would start from zero
+	static std::vector<std::pair<const char *, const std::vector<double_t> Result::*>> start_vectors(const std::string &engine)
+	{
+		if (engine == "admm")
+			return { { "x", &Result::x }, { "s", &Result::s }, { "y", &Result::y } };
+		if (engine == "drs")
+			return { { "z", &Result::z } };
+		return { { "x", &Result::x }, { "y", &Result::y } };
+	}
+
+	CommandLine parse_command_line(int argc, char **argv)
+	{
+		CommandLine command;
+		bool positional = false;
+		for (int i = 1; i < argc; ++i) {
+			std::string arg = argv[i];
+			if (arg == "--sparse") {
+				command.sparse = true;
+			}
+			else if (arg == "--tolerance") {
+				if (++i == argc)
+					throw Error("--tolerance needs a value");
+				double_t eps;
+				try {
+					eps = std::stod(argv[i]);
+				}
+				catch (const std::exception &) {
+					throw Error("invalid tolerance " + std::string(argv[i]));
+				}
+				command.tolerances.primal = eps;
+				command.tolerances.dual = eps;
+				command.tolerances.gap = eps;
+			}
+			else if (arg == "--checkpoint" || arg == "--resume" || arg == "--warm-start" || arg == "--trace" || arg == "--profile") {
+				if (++i == argc)
+					throw Error(arg + " needs a file");
+				if (arg == "--checkpoint")
+					command.checkpoint.path = argv[i];
+				else if (arg == "--trace")
+					command.trace.path = argv[i];
+				else if (arg == "--profile")
+					command.profile = argv[i];
+				else if (arg == "--resume")
+					command.resume = argv[i];
+				else
+					command.warmStart = argv[i];
+			}
+			else if (arg == "--blas-threads") {
+				if (++i == argc)
+					throw Error("--blas-threads needs a value");
+				int32_t threads;
+				try {
+					threads = std::stoi(argv[i]);
+				}
+				catch (const std::exception &) {
+					throw Error("invalid thread count " + std::string(argv[i]));
+				}
+				if (threads <= 0)
+					throw Error("invalid thread count " + std::string(argv[i]));
+				command.blasThreads = threads;
+			}
+			else if (arg == "--print-interval") {
+				if (++i == argc)
+					throw Error("--print-interval needs a value");
+				int32_t interval;
+				try {
+					interval = std::stoi(argv[i]);
+				}
+				catch (const std::exception &) {
+					throw Error("invalid print interval " + std::string(argv[i]));
+				}
+				if (interval < 0)
+					throw Error("invalid print interval " + std::string(argv[i]));
+				command.trace.printInterval = interval;
+			}
+			else if (arg == "--checkpoint-interval") {
+				if (++i == argc)
+					throw Error("--checkpoint-interval needs a value");
+				int32_t interval;
+				try {
+					interval = std::stoi(argv[i]);
+				}
+				catch (const std::exception &) {
+					throw Error("invalid checkpoint interval " + std::string(argv[i]));
+				}
+				if (interval <= 0)
+					throw Error("invalid checkpoint interval " + std::string(argv[i]));
+				command.checkpoint.interval = interval;
+			}
+			else if (arg.size() > 1 && arg[0] == '-') {
+				throw Error("unknown option " + arg);
+			}
+			else if (!positional) {
+				command.problem = arg;
+				positional = true;
+			}
+			else {
+				throw Error("unexpected argument " + arg);
+			}
+		}
+		if (!command.resume.empty() && !command.warmStart.empty())
+			throw Error("--resume and --warm-start are exclusive");
+		return command;
+	}
+
+	Problem load_problem(const CommandLine &command)
+	{
+		Problem problem = load_problem(command.problem);
+		if (command.sparse)
+			return make_sparse(problem);
+		return problem;
+	}
+
+	void configure_blas(const CommandLine &command)
+	{
+		if (command.blasThreads == 0)
+			return;
+		set_blas_threading(command.blasThreads == 1 ? eBLAS_SEQUENTIAL : eBLAS_THREADED);
+		set_blas_threads(command.blasThreads);
+	}
+
+	bool load_start(const CommandLine &command, const std::string &engine, const Problem &problem, Result &start)
+	{
+		bool resume = !command.resume.empty();
+		const std::string &path = resume ? command.resume : command.warmStart;
+		if (path.empty())
+			return false;
+
+		Checkpoint checkpoint = read_checkpoint(path);
+		if (checkpoint.m != problem.m || checkpoint.n != problem.n)
+			throw Error(path + " holds a " + std::to_string(checkpoint.m) + " x " + std::to_string(checkpoint.n)
+				+ " problem, not " + std::to_string(problem.m) + " x " + std::to_string(problem.n));
+		if (resume && checkpoint.engine != engine)
+			throw Error(path + " was written by " + checkpoint.engine + ", not " + engine);
+		if (resume) {
+			if (!checkpoint.fingerprint.known())
+				std::cerr << "cvx : warning: " << path << " has no fingerprint of A, b and c (an older version), resuming without checking that it belongs to this problem" << std::endl;
+			else if (checkpoint.fingerprint != fingerprint_of(problem))
+				throw Error(path + " was written for a different problem of the same dimensions");
+		}
+		else {
+			//vectors the snapshot lacks would silently start from zero
+			std::string missing;
+			size_t count = 0;
+			auto vectors = start_vectors(engine);
+			for (const auto &vector : vectors) {
+				if ((checkpoint.state.*vector.second).empty()) {
+					missing.append(missing.empty() ? "" : ", ").append(vector.first);
+					++count;
+				}
+			}
+			if (count == vectors.size())
+				throw Error(path + " (" + checkpoint.engine + ") holds none of the vectors " + engine + " starts from: " + missing);
+			if (count > 0)
+				std::cerr << "cvx : warning: " << path << " (" << checkpoint.engine << ") holds no " << missing << ", " << engine << (count > 1 ? " starts them" : " starts it") << " from zero" << std::endl;
+		}
+
+		start = std::move(checkpoint.state);
+		if (!resume) {
+			//only the iterates carry over to a new solve
+			start.iterations = 0;
+			start.penalty = 0.0;
+			start.converged = false;
+		}
+		return true;
+	}
+}
@@ -0,0 +1,58 @@
+#ifndef _CVX_CLI_HPP_
+#define _CVX_CLI_HPP_
+
+#include "checkpoint.hpp"
+#include "trace.hpp"
+
+// Command line shared by the solver executables
+// [--sparse] [--tolerance eps] [--checkpoint file [--checkpoint-interval k]]
+// [--resume file | --warm-start file] [--blas-threads k] [--print-interval k]
+// [--trace file] [--profile file] [problem]
+//	problem		binary problem file or CSV directory (default: working directory)
+//	--sparse	store A as CSR even when the input is dense
+//	--tolerance	stop once the scaled primal and dual residuals and the relative
+//				gap are all <= eps (default 1e-4), a negative eps runs the
+//				full iteration budget
+//	--checkpoint	write the engine state to file every k iterations
+//				(default 100) and once more at the end
+//	--resume	continue the run checkpointed in file: iterates, iteration
+//				count and penalty; the engine and the problem must match
+//				(dimensions, nonzeros of A and a hash of b and c)
+//	--warm-start	start from the iterates in file, a checkpoint of any engine
+//				on a problem of the same dimensions, e.g. yesterday's solve;
+//				vectors the file lacks start from zero with a warning, a
+//				file with none of them is refused
+//	--blas-threads	1 selects the sequential BLAS, k > 1 the threaded one with
+//				k threads (default: the BLAS library's own choice)
+//	--print-interval	print every k-th iteration (default 100, 0 only the last)
+//	--trace		dump the iteration trace to file at the end, CSV when the
+//				name ends in .csv, binary otherwise (see trace.hpp)
+//	--profile	write the per-phase timings as JSON to file (see profile.hpp)
+
+namespace cvx
+{
+	struct CommandLine
+	{
+		std::string problem = ".";
+		bool sparse = false;
+		Tolerances tolerances;
+		CheckpointOptions checkpoint;
+		TraceOptions trace;
+		std::string profile;
+		std::string resume;
+		std::string warmStart;
+		// 0 leaves the BLAS threading alone
+		int32_t blasThreads = 0;
+	};
+
+	// throws Error on unknown options
+	CommandLine parse_command_line(int argc, char **argv);
+	Problem load_problem(const CommandLine &command);
+	// applies --blas-threads, before the first BLAS call
+	void configure_blas(const CommandLine &command);
+	// fills start from --resume or --warm-start for engine ("alm", "ssn",
+	// "admm" or "drs"); false when neither was given
+	bool load_start(const CommandLine &command, const std::string &engine, const Problem &problem, Result &start);
+}
+
+#endif /*!_CVX_CLI_HPP_*/
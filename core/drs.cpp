@@ -0,0 +1,166 @@
+#include "drs.hpp"
+#include "anderson.hpp"
+#include "kernels.hpp"
+#include "profile.hpp"
+#include "linear_solver.hpp"
+#include "workspace.hpp"
+
+namespace cvx {
+
+	// eigenvalues of A * A^T below this fraction of the largest are dropped
+	// from the projector, as those of a zero or dependent row of A
+	const static double_t rankTolerance = 1e-10;
+	// az is recomputed as A * z this often, the update below relies on
+	// A * u = b, which holds only up to rounding
+	const static int32_t refreshInterval = 50;
+
+	Result solve_drs(const Problem &problem, const DrsOptions &options, const Result *start)
+	{
+		Profiler profiler(options.profile, "drs");
+		const int32_t m = problem.m;
+		const int32_t n = problem.n;
+		double_t t = options.t;
+		if (t <= 0.0 && start != nullptr && start->penalty > 0.0)
+			t = start->penalty;
+		if (t <= 0.0)
+			t = options.stepScale * penalty_scale(problem, estimate_norm(problem));
+		const double_t *c = problem.c;
+
+		Workspace workspace;
+		double_t *x = workspace.vector(n);
+		double_t *u = workspace.vector(n);
+		//z and az = A * z side by side, Anderson combines both
+		double_t *z = workspace.vector(n + m);
+		double_t *az = z + n;
+		double_t *point = workspace.vector(n);
+		double_t *y = workspace.vector(n);
+		double_t *temp = workspace.vector(m);
+		double_t *multiplier = workspace.vector(m);
+		double_t *residual = workspace.vector(m);
+		double_t *aty = workspace.vector(n);
+		double_t *shift = workspace.vector(m);
+		double_t *system = workspace.vector((size_t)m * m);
+
+		initial_iterate(start ? &start->x : nullptr, x, n);
+		initial_iterate(start ? &start->z : nullptr, z, n);
+
+		//shift = t * A * c + b, constant
+		cblas_dcopy(m, problem.b, 1, shift, 1);
+		multiply_A(problem, t, c, 1.0, shift);
+		//system = A * A^T, decomposed once; the pseudo-inverse keeps a
+		//singular A * A^T (a 0 = 0 row) an exact projection onto {Ax = b}
+		gram(problem, 1.0, 0.0, system);
+		SpectralSolver projector;
+		projector.decompose(system, m);
+		projector.set_pseudo_inverse(rankTolerance);
+
+		//az = A * z, carried along so that A * x needs no product of its own
+		multiply_A(problem, 1.0, z, 0.0, az);
+
+		Anderson anderson(n, m, options.andersonMemory);
+
+		Trace trace(options.trace);
+		Checkpointer checkpointer(options.checkpoint, "drs", problem);
+		//x, residual, multiplier, aty and u already belong to z
+		bool evaluated = false;
+		//the iterate handed to the checkpoint writer: x, the multiplier and
+		//the z they were evaluated at, which is point unless Anderson has
+		//just rejected it; u and az follow from z
+		auto snapshot = [&](Result state) {
+			const double_t *accepted = evaluated ? z : point;
+			state.x.assign(x, x + n);
+			state.y.assign(multiplier, multiplier + m);
+			state.z.assign(accepted, accepted + n);
+			state.penalty = t;
+			return state;
+		};
+
+		//one application of the DRS map at z: x, residual = A * x - b, the
+		//multiplier with aty = A^T * multiplier, and u
+		auto evaluate = [&]() {
+			//update of x
+			//projection z to R+
+			project_nonneg(n, 1.0, z, x);
+
+			//update of u
+			//y = 2 * x - z
+			cblas_daxpby(n, 2.0, x, 1, 0.0, y, 1);
+			cblas_daxpby(n, -1.0, z, 1, 1.0, y, 1);
+			//temp = A * y
+			multiply_A(problem, 1.0, y, 0.0, temp);
+			//residual = A * x - b = (A * y + A * z) / 2 - b
+			cblas_dcopy(m, problem.b, 1, residual, 1);
+			cblas_daxpby(m, 0.5, temp, 1, -1.0, residual, 1);
+			cblas_daxpy(m, 0.5, az, 1, residual, 1);
+			//temp = (A * A^T)^-1 * (A * y - t * A * c - b)
+			cblas_daxpby(m, -1.0, shift, 1, 1.0, temp, 1);
+			projector.solve(temp);
+			//multiplier = -temp / t, aty = A^T * multiplier
+			cblas_daxpby(m, -1.0 / t, temp, 1, 0.0, multiplier, 1);
+			multiply_At(problem, 1.0, multiplier, 0.0, aty);
+			//u = y - t * c + t * aty
+			cblas_daxpby(n, 1.0, y, 1, 0.0, u, 1);
+			cblas_daxpby(n, -t, c, 1, 1.0, u, 1);
+			cblas_daxpy(n, t, aty, 1, u, 1);
+		};
+
+		Result result;
+		const int32_t first = start ? start->iterations : 0;
+		result.iterations = first;
+		cblas_dcopy(n, z, 1, point, 1);
+		for (int32_t outer = first; outer < options.outerCount; ++outer) {
+			if (!evaluated)
+				evaluate();
+			evaluated = false;
+			//point = z, the argument of this step of the fixed-point map
+			cblas_dcopy(n, z, 1, point, 1);
+
+			//update of z
+			//z = z + u - x
+			cblas_daxpby(n, 1.0, u, 1, 1.0, z, 1);
+			cblas_daxpby(n, -1.0, x, 1, 1.0, z, 1);
+			//az = A * z + A * u - A * x = az - residual, as A * u = b
+			cblas_daxpy(m, -1.0, residual, 1, az, 1);
+			//z = z - dG * gamma, together with az
+			anderson.step(point, z);
+			if (anderson.rejected()) {
+				//point was an extrapolation Anderson threw away, z is now the
+				//plain image of the last accepted point: x and the rest are
+				//taken from there, so only accepted iterates are recorded,
+				//checkpointed and returned
+				evaluate();
+				evaluated = true;
+			}
+
+			result.primal = primal_objective(problem, x);
+			result.dual = dual_objective(problem, multiplier);
+			result.iterations = outer + 1;
+
+			result.residuals.primal = primal_infeasibility(problem, residual);
+			result.residuals.dual = dual_infeasibility(problem, aty);
+			result.residuals.gap = relative_gap(result.primal, result.dual);
+			bool met = options.tolerances.met(result.residuals);
+			if (met || result.iterations % refreshInterval == 0) {
+				//residual = A * x - b and az = A * z from fresh products
+				multiply_A(problem, 1.0, x, 0.0, residual);
+				cblas_daxpy(m, -1.0, problem.b, 1, residual, 1);
+				multiply_A(problem, 1.0, z, 0.0, az);
+				result.residuals.primal = primal_infeasibility(problem, residual);
+				met = options.tolerances.met(result.residuals);
+			}
+			trace.record(result.iterations, result.primal, result.dual, result.residuals);
+			if (met) {
+				result.converged = true;
+				break;
+			}
+			if (checkpointer.due(result.iterations))
+				checkpointer.save(snapshot(result));
+		}
+		trace.finish(result);
+
+		result = snapshot(std::move(result));
+		checkpointer.finish(result);
+		profiler.finish(result.iterations);
+		return result;
+	}
+}
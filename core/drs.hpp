@@ -0,0 +1,60 @@
+#ifndef _CVX_DRS_HPP_
+#define _CVX_DRS_HPP_
+
+#include "checkpoint.hpp"
+#include "trace.hpp"
+
+// DRS for the primal problem
+// min c^T * x
+// s.t. A * x = b
+//		x >= 0
+// x+ = prox_{th}{z}
+// h(x) = 1_{x>=0}(x)
+// prox_{th}(z) = projection_{R+}(z)
+// u+ = prox_{tf}(2x-z)
+// f(x) = c^T * x + 1_{Ax=b}(x)
+// prox_{tf}(y) = (y - t*c)-A^T*(AA^T)^-1*(A*y-t*A*c-b)
+// z+ = z + u+ - x+
+// A*c and b + t*A*c are computed once and AA^T is eigendecomposed once,
+// so prox_{tf} is an exact projection onto {Ax = b} that costs one A*v, one
+// cached m x m solve and one A^T*w per iteration. (AA^T)^-1 is the
+// pseudo-inverse, so a zero or dependent row of A does not break it
+// The multiplier of Ax = b in prox_{tf}(y) is -(AA^T)^-1*(A*y-t*A*c-b)/t, the
+// dual iterate, and its A^T product gives the dual residual. A*x = (A*(2x-z) + A*z)/2 and
+// A*z_+ = A*z + b - A*x, so the primal residual needs no extra product either;
+// A*z is recomputed every 50 iterations and before convergence is declared,
+// so rounding in A*u = b cannot drift into the stopping test
+// The map z -> z_+ is accelerated with type-II Anderson acceleration (see
+// anderson.hpp); A*z rides along as a tracked entry so it stays exact. When
+// Anderson rejects an extrapolated z, x and the multiplier are evaluated
+// again at the z it falls back to, so every recorded, checkpointed or
+// returned x belongs to an accepted z (the returned z)
+
+namespace cvx
+{
+	struct DrsOptions
+	{
+		// step, 0 picks stepScale * ||b|| / (||A||_2 * ||c||)
+		double_t t = 0;
+		double_t stepScale = 10;
+		// Anderson acceleration of z <- z + u - x over this many past steps,
+		// 0 runs the plain iteration
+		int32_t andersonMemory = 10;
+		int32_t outerCount = 3000;
+		// checked after every iteration
+		Tolerances tolerances;
+		// periodic snapshots of the state for --resume, see checkpoint.hpp
+		CheckpointOptions checkpoint;
+		// printed lines and the in-memory iteration trace, see trace.hpp
+		TraceOptions trace;
+		// JSON report of the per-phase timers, see profile.hpp
+		std::string profile;
+	};
+
+	// start may carry x (n) and z (n), missing vectors start from zero; a
+	// resumed start also continues its iteration count and t (penalty). The
+	// result also carries the multiplier y (m)
+	Result solve_drs(const Problem &problem, const DrsOptions &options, const Result *start = nullptr);
+}
+
+#endif /*!_CVX_DRS_HPP_*/
@@ -0,0 +1,395 @@
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstdio>
+#include <thread>
+#include "binary.hpp"
+#include "generator.hpp"
+#include "parallel.hpp"
+#include "sparse.hpp"
+#include "workspace.hpp"
+
+namespace cvx {
+
+	// splitmix64 over a counter, one stream per (seed, stream id)
+	class Stream
+	{
+	public:
+		Stream(uint64_t seed, uint64_t id) : _state(seed ^ (id * 0xD1B54A32D192ED03ull)) {}
+
+		uint64_t next(void)
+		{
+			uint64_t z = (_state += 0x9E3779B97F4A7C15ull);
+			z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+			z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+			return z ^ (z >> 31);
+		}
+		// (0, 1], never 0 so that log() stays finite
+		double_t uniform(void)
+		{
+			return ((next() >> 11) + 1) * 0x1.0p-53;
+		}
+		// Box-Muller, the second value is dropped
+		double_t normal(void)
+		{
+			double_t radius = std::sqrt(-2.0 * std::log(uniform()));
+			return radius * std::cos(2.0 * M_PI * uniform());
+		}
+
+	private:
+		uint64_t _state;
+	};
+
+	//stream ids: 0 xs, 1 y and s, 2 + i row i of A
+	const static uint64_t vectorStream = 0;
+	const static uint64_t dualStream = 1;
+	const static uint64_t rowStream = 2;
+
+	Generator::Generator(const GeneratorOptions &options) :
+		_options(options)
+	{
+		const int32_t m = options.m;
+		const int32_t n = options.n;
+		if (m <= 0 || n <= 0)
+			throw Error("generator dimensions must be positive");
+		if (!(options.density > 0.0 && options.density <= 1.0))
+			throw Error("generator density must be in (0, 1]");
+
+		//xs = |sprandn(n, 1, m / n)|
+		Stream vector(options.seed, vectorStream);
+		const double_t fill = std::min(1.0, (double_t)m / n);
+		_xs.assign(n, 0.0);
+		for (int32_t j = 0; j < n; ++j) {
+			if (vector.uniform() <= fill)
+				_xs[j] = std::abs(vector.normal());
+		}
+		//y = randn(m, 1), s = rand(n, 1) .* (xs == 0)
+		Stream dual(options.seed, dualStream);
+		_y.resize(m);
+		for (int32_t i = 0; i < m; ++i) {
+			_y[i] = dual.normal();
+		}
+		_s.resize(n);
+		for (int32_t j = 0; j < n; ++j) {
+			double_t u = dual.uniform();
+			_s[j] = _xs[j] == 0.0 ? u : 0.0;
+		}
+	}
+
+	void Generator::dense_row(int32_t i, double_t *row) const
+	{
+		const int32_t n = _options.n;
+		Stream stream(_options.seed, rowStream + i);
+		if (!sparse()) {
+			for (int32_t j = 0; j < n; ++j) {
+				row[j] = stream.uniform();
+			}
+			return;
+		}
+		std::fill(row, row + n, 0.0);
+		std::vector<int32_t> columns;
+		std::vector<double_t> values;
+		int32_t count = sparse_row(i, columns, values);
+		for (int32_t k = 0; k < count; ++k) {
+			row[columns[k]] = values[k];
+		}
+	}
+
+	int32_t Generator::sparse_row(int32_t i, std::vector<int32_t> &columns, std::vector<double_t> &values) const
+	{
+		const int32_t n = _options.n;
+		Stream stream(_options.seed, rowStream + i);
+		if (!sparse()) {
+			for (int32_t j = 0; j < n; ++j) {
+				columns.push_back(j);
+				values.push_back(stream.uniform());
+			}
+			return n;
+		}
+		//geometric gaps between nonzeros, O(nonzeros) per row
+		const double_t scale = 1.0 / std::log1p(-_options.density);
+		int32_t count = 0;
+		for (double_t j = -1.0; ; ) {
+			j += 1.0 + std::floor(std::log(stream.uniform()) * scale);
+			if (j >= n)
+				break;
+			columns.push_back((int32_t)j);
+			values.push_back(stream.uniform());
+			++count;
+		}
+		//an empty row would make A rank deficient, it gets one entry
+		if (count == 0) {
+			columns.push_back(std::min(n - 1, (int32_t)(stream.uniform() * n)));
+			values.push_back(stream.uniform());
+			++count;
+		}
+		return count;
+	}
+
+	int32_t Generator::row_nonzeros(int32_t i) const
+	{
+		const int32_t n = _options.n;
+		if (!sparse())
+			return n;
+		Stream stream(_options.seed, rowStream + i);
+		const double_t scale = 1.0 / std::log1p(-_options.density);
+		int32_t count = 0;
+		for (double_t j = -1.0; ; ++count) {
+			j += 1.0 + std::floor(std::log(stream.uniform()) * scale);
+			if (j >= n)
+				break;
+			//the value
+			stream.next();
+		}
+		return std::max(count, 1);
+	}
+
+	double_t Generator::accumulate(int32_t i, const int32_t *columns, const double_t *values, int32_t count, double_t *c) const
+	{
+		const double_t yi = _y[i];
+		double_t bi = 0.0;
+		for (int32_t k = 0; k < count; ++k) {
+			bi += values[k] * _xs[columns[k]];
+			c[columns[k]] += yi * values[k];
+		}
+		return bi;
+	}
+
+	double_t Generator::accumulate(int32_t i, const double_t *row, double_t *c) const
+	{
+		const double_t yi = _y[i];
+		double_t bi = 0.0;
+		for (int32_t j = 0; j < _options.n; ++j) {
+			if (row[j] == 0.0)
+				continue;
+			bi += row[j] * _xs[j];
+			c[j] += yi * row[j];
+		}
+		return bi;
+	}
+
+	Problem generate_problem(const GeneratorOptions &options)
+	{
+		Generator generator(options);
+		const int32_t m = options.m;
+		const int32_t n = options.n;
+
+		Problem problem;
+		if (!generator.sparse()) {
+			problem = allocate_problem(m, n);
+			std::copy(generator.s().begin(), generator.s().end(), problem.c);
+			for (int32_t i = 0; i < m; ++i) {
+				double_t *row = problem.A + (size_t)i * n;
+				generator.dense_row(i, row);
+				problem.b[i] = generator.accumulate(i, row, problem.c);
+			}
+			return problem;
+		}
+
+		std::shared_ptr<Workspace> storage = std::make_shared<Workspace>();
+		problem.m = m;
+		problem.n = n;
+		problem.layout = eCSR;
+		problem.b = storage->vector(m);
+		problem.c = storage->vector(n);
+		problem.storage = storage;
+		std::copy(generator.s().begin(), generator.s().end(), problem.c);
+
+		std::vector<int64_t> rowPtr(1, 0);
+		std::vector<int32_t> colIdx;
+		std::vector<double_t> values;
+		rowPtr.reserve(m + 1);
+		for (int32_t i = 0; i < m; ++i) {
+			int32_t count = generator.sparse_row(i, colIdx, values);
+			size_t first = colIdx.size() - count;
+			problem.b[i] = generator.accumulate(i, colIdx.data() + first, values.data() + first, count, problem.c);
+			rowPtr.push_back((int64_t)colIdx.size());
+		}
+		problem.sparse = SparseMatrix::from_csr(m, n, std::move(rowPtr), std::move(colIdx), std::move(values));
+		return problem;
+	}
+
+	// rows drawn by one thread for the current block
+	struct RowSlice
+	{
+		std::vector<int32_t> columns;
+		std::vector<double_t> values;
+		std::vector<int32_t> counts;
+	};
+
+	// entries drawn per block, bounds the memory of a stream to about 200 MB
+	const static double_t blockEntries = 16.0 * 1024 * 1024;
+
+	// Draws the rows on threads a block at a time and hands them to sink(i,
+	// columns, values, count, b_i) in row order. b and c are accumulated on
+	// the calling thread in row order, so they do not depend on threads.
+	template<typename Sink>
+	static double_t stream_rows(const Generator &generator, int32_t threads, std::vector<double_t> &b, std::vector<double_t> &c, Sink sink)
+	{
+		const int32_t m = generator.m();
+		const int32_t n = generator.n();
+		if (threads <= 0)
+			threads = std::max(1u, std::thread::hardware_concurrency());
+		const double_t rowEntries = std::max(1.0, (double_t)n * (generator.sparse() ? generator.options().density : 1.0));
+		const int32_t blockRows = (int32_t)std::min<double_t>(m, std::max<double_t>(threads, blockEntries / rowEntries));
+
+		b.assign(m, 0.0);
+		c = generator.s();
+		std::vector<RowSlice> slices(threads);
+		for (int32_t first = 0; first < m; first += blockRows) {
+			const int32_t rows = std::min(blockRows, m - first);
+			const int32_t perSlice = (rows + threads - 1) / threads;
+			run_parallel(threads, [&](size_t t) {
+				RowSlice &slice = slices[t];
+				slice.columns.clear();
+				slice.values.clear();
+				slice.counts.clear();
+				const int32_t begin = first + (int32_t)t * perSlice;
+				const int32_t end = std::min(first + rows, begin + perSlice);
+				for (int32_t i = begin; i < end; ++i) {
+					slice.counts.push_back(generator.sparse_row(i, slice.columns, slice.values));
+				}
+			});
+
+			int32_t i = first;
+			for (const RowSlice &slice : slices) {
+				size_t offset = 0;
+				for (int32_t count : slice.counts) {
+					const int32_t *columns = slice.columns.data() + offset;
+					const double_t *values = slice.values.data() + offset;
+					b[i] = generator.accumulate(i, columns, values, count, c.data());
+					sink(i, columns, values, count);
+					offset += count;
+					++i;
+				}
+			}
+		}
+
+		//c^T * xs = y^T * A * xs + s^T * xs and s^T * xs = 0
+		double_t objective = 0.0;
+		for (int32_t i = 0; i < m; ++i) {
+			objective += b[i] * generator.y()[i];
+		}
+		return objective;
+	}
+
+	double_t write_generated_binary(const GeneratorOptions &options, const std::string &path, int32_t threads)
+	{
+		Generator generator(options);
+		const int32_t m = options.m;
+		const int32_t n = options.n;
+
+		//the values section of a CSR file starts after nnz column indices
+		int64_t nnz = -1;
+		if (generator.sparse()) {
+			const int32_t count = threads > 0 ? threads : std::max(1u, std::thread::hardware_concurrency());
+			std::vector<int64_t> partial(count, 0);
+			run_parallel(count, [&](size_t t) {
+				for (int32_t i = (int32_t)t; i < m; i += count) {
+					partial[t] += generator.row_nonzeros(i);
+				}
+			});
+			nnz = 0;
+			for (int64_t part : partial)
+				nnz += part;
+		}
+
+		BinaryWriter writer(path, m, n, nnz);
+		std::vector<double_t> b;
+		std::vector<double_t> c;
+		double_t objective = stream_rows(generator, threads, b, c, [&](int32_t, const int32_t *columns, const double_t *values, int32_t count) {
+			if (generator.sparse())
+				writer.sparse_row(columns, values, count);
+			else
+				writer.dense_row(values);
+		});
+		writer.finish(b.data(), c.data());
+		return objective;
+	}
+
+	// buffered text output that removes the file unless closed
+	class CsvFile
+	{
+	public:
+		explicit CsvFile(const std::string &path) : _path(path), _file(fopen(path.c_str(), "wb"))
+		{
+			if (_file == nullptr)
+				throw Error(std::string("Failed to create ").append(path));
+			_buffer.reserve(bufferSize + 64);
+		}
+		~CsvFile(void)
+		{
+			if (_file != nullptr) {
+				fclose(_file);
+				remove(_path.c_str());
+			}
+		}
+
+		// shortest text that parses back to the same double
+		void value(double_t x, char separator)
+		{
+			char text[32];
+			std::to_chars_result end = std::to_chars(text, text + sizeof(text), x);
+			_buffer.append(text, end.ptr);
+			_buffer.push_back(separator);
+			if (_buffer.size() >= bufferSize)
+				flush();
+		}
+		void close(void)
+		{
+			flush();
+			FILE *file = _file;
+			_file = nullptr;
+			if (fclose(file) != 0) {
+				remove(_path.c_str());
+				throw Error(std::string("Failed to write ").append(_path));
+			}
+		}
+
+	private:
+		void flush(void)
+		{
+			if (fwrite(_buffer.data(), 1, _buffer.size(), _file) != _buffer.size())
+				throw Error(std::string("Failed to write ").append(_path));
+			_buffer.clear();
+		}
+
+	private:
+		const static size_t bufferSize = 1 << 20;
+		std::string _path;
+		FILE *_file;
+		std::string _buffer;
+	};
+
+	double_t write_generated_csv(const GeneratorOptions &options, const std::string &directory, int32_t threads)
+	{
+		Generator generator(options);
+		const int32_t n = options.n;
+
+		CsvFile A(directory + "/A.csv");
+		std::vector<double_t> b;
+		std::vector<double_t> c;
+		std::vector<double_t> row(n);
+		double_t objective = stream_rows(generator, threads, b, c, [&](int32_t, const int32_t *columns, const double_t *values, int32_t count) {
+			//CSV rows are dense
+			std::fill(row.begin(), row.end(), 0.0);
+			for (int32_t k = 0; k < count; ++k) {
+				row[columns[k]] = values[k];
+			}
+			for (int32_t j = 0; j < n; ++j) {
+				A.value(row[j], j + 1 < n ? ',' : '\n');
+			}
+		});
+		A.close();
+
+		CsvFile bFile(directory + "/b.csv");
+		for (double_t x : b)
+			bFile.value(x, '\n');
+		bFile.close();
+		CsvFile cFile(directory + "/c.csv");
+		for (double_t x : c)
+			cFile.value(x, '\n');
+		cFile.close();
+		return objective;
+	}
+}
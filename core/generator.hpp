@@ -0,0 +1,74 @@
+#ifndef _CVX_GENERATOR_HPP_
+#define _CVX_GENERATOR_HPP_
+
+#include "problem.hpp"
+
+// Synthetic feasible LP, the construction of matlab/gendata.m
+//	A = rand(m, n), or each entry nonzero with probability density and a
+//	row left empty given one nonzero at a random column
+//	xs = |sprandn(n, 1, m / n)|, b = A * xs
+//	y = randn(m, 1), s = rand(n, 1) .* (xs == 0), c = A^T * y + s
+// so xs is primal and (y, s) dual optimal, the optimum is c^T * xs.
+// Every row of A has its own stream derived from the seed (splitmix64, with
+// the uniform and normal conversions done here rather than by <random>), so a
+// row can be produced on its own, in any order, and a seed gives the same
+// instance on every platform.
+
+namespace cvx
+{
+	struct GeneratorOptions
+	{
+		int32_t m = 20;
+		int32_t n = 100;
+		// probability of an entry of A being nonzero, 1 is the dense rand(m, n)
+		double_t density = 1.0;
+		uint64_t seed = 1;
+	};
+
+	class Generator
+	{
+	public:
+		// draws xs, y and s
+		explicit Generator(const GeneratorOptions &options);
+
+	public:
+		const GeneratorOptions &options(void) const { return _options; }
+		int32_t m(void) const { return _options.m; }
+		int32_t n(void) const { return _options.n; }
+		bool sparse(void) const { return _options.density < 1.0; }
+		// row i of A, n entries with the zeros
+		void dense_row(int32_t i, double_t *row) const;
+		// nonzeros of row i of A in ascending columns, appended to columns and
+		// values; returns how many were appended
+		int32_t sparse_row(int32_t i, std::vector<int32_t> &columns, std::vector<double_t> &values) const;
+		// what sparse_row(i) would return, without keeping the entries
+		int32_t row_nonzeros(int32_t i) const;
+		// b_i = a_i^T * xs and c += y_i * a_i for row i given by its nonzeros;
+		// c starts as s
+		double_t accumulate(int32_t i, const int32_t *columns, const double_t *values, int32_t count, double_t *c) const;
+		double_t accumulate(int32_t i, const double_t *row, double_t *c) const;
+		const std::vector<double_t> &xs(void) const { return _xs; }
+		const std::vector<double_t> &y(void) const { return _y; }
+		const std::vector<double_t> &s(void) const { return _s; }
+
+	private:
+		GeneratorOptions _options;
+		std::vector<double_t> _xs;
+		std::vector<double_t> _y;
+		std::vector<double_t> _s;
+	};
+
+	// the whole instance in memory: row-major A, or CSR when density < 1
+	Problem generate_problem(const GeneratorOptions &options);
+
+	// Stream the same instance to disk a block of rows at a time, so only b,
+	// c and the block are ever in memory: the binary format (row-major, or
+	// CSR when density < 1, which costs a first pass counting the nonzeros)
+	// or A.csv, b.csv and c.csv in an existing directory. threads <= 0 draws
+	// rows on every hardware thread, the output does not depend on it.
+	// Both return the optimal objective c^T * xs = b^T * y.
+	double_t write_generated_binary(const GeneratorOptions &options, const std::string &path, int32_t threads = 0);
+	double_t write_generated_csv(const GeneratorOptions &options, const std::string &directory, int32_t threads = 0);
+}
+
+#endif /*!_CVX_GENERATOR_HPP_*/
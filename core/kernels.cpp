@@ -0,0 +1,432 @@
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include "kernels.hpp"
+#include "profile.hpp"
+#include "sparse.hpp"
+#include "workspace.hpp"
+
+namespace cvx {
+
+	// bytes of A a fused tile should span, sized to stay in L2
+	const static size_t tileBytes = 1024 * 1024;
+	// shortest row tile of a row-major A worth fusing, see alm_inner_rows
+	const static size_t minTileRows = 16;
+
+#if defined(CVX_USE_MKL) && defined(CVX_MKL_ILP64)
+	// mkl_rt runs LP64 unless switched before its first call; every engine
+	// links this file, so a static initializer gets there first
+	const static int interfaceLayer = mkl_set_interface_layer(MKL_INTERFACE_ILP64);
+#endif
+
+	// flops of one product with A, 2 per entry or nonzero
+	static inline double_t flops_of_A(const Problem &problem)
+	{
+		return problem.is_sparse() ? 2.0 * problem.sparse->nnz() : 2.0 * problem.m * problem.n;
+	}
+
+	// bytes of A one product streams, values and indices for CSR
+	static inline double_t bytes_of_A(const Problem &problem)
+	{
+		if (problem.is_sparse())
+			return 12.0 * problem.sparse->nnz() + 8.0 * (problem.m + 1);
+		return 8.0 * problem.m * problem.n;
+	}
+
+	// flops of A_J * A_J^T, 2 per pair of nonzeros sharing a column for CSR
+	static inline double_t flops_of_gram(const Problem &problem, const int32_t *columns, int32_t count)
+	{
+		if (!problem.is_sparse())
+			return (double_t)problem.m * problem.m * count;
+		const int64_t *colPtr = problem.sparse->col_ptr();
+		double_t flops = 0.0;
+		for (int32_t k = 0; k < count; ++k) {
+			int32_t j = columns ? columns[k] : k;
+			double_t entries = colPtr[j + 1] - colPtr[j];
+			flops += entries * entries;
+		}
+		return flops;
+	}
+
+	static double_t shifted_projection(double_t x, double_t c, double_t sigma, double_t aty)
+	{
+		double_t value = x - sigma * (c - aty);
+		return value > 0.0 ? value : 0.0;
+	}
+
+	//one pass over the column tiles of A, then the y step
+	static void alm_inner_columns(const Problem &problem, const double_t *x, double_t sigma, double_t t, double_t *y, double_t *projection, double_t *gradient)
+	{
+		const int32_t m = problem.m;
+		const int32_t n = problem.n;
+		const double_t *c = problem.c;
+
+		if (problem.is_sparse()) {
+			const SparseMatrix &A = *problem.sparse;
+			const int64_t *colPtr = A.col_ptr();
+			const int32_t *rowIdx = A.row_idx();
+			const double_t *values = A.col_values();
+			std::fill(gradient, gradient + m, 0.0);
+			for (int32_t j = 0; j < n; ++j) {
+				double_t aty = 0.0;
+				for (int64_t k = colPtr[j]; k < colPtr[j + 1]; ++k) {
+					aty += values[k] * y[rowIdx[k]];
+				}
+				double_t p = shifted_projection(x[j], c[j], sigma, aty);
+				projection[j] = p;
+				if (p == 0.0)
+					continue;
+				for (int64_t k = colPtr[j]; k < colPtr[j + 1]; ++k) {
+					gradient[rowIdx[k]] += values[k] * p;
+				}
+			}
+		}
+		else {
+			const int32_t width = (int32_t)std::max<size_t>(1, tileBytes / (sizeof(double_t) * std::max(m, 1)));
+			for (int32_t j = 0; j < n; j += width) {
+				const int32_t columns = std::min(width, n - j);
+				const double_t *tile = problem.A + (size_t)j * m;
+				//projection_J = A_J^T * y
+				cblas_dgemv(CblasColMajor, CblasTrans, m, columns, 1.0, tile, m, y, 1, 0.0, projection + j, 1);
+				//projection_J = P_+(x_J - sigma * (c_J - projection_J))
+				project_shifted(columns, x + j, c + j, sigma, projection + j, projection + j);
+				//gradient += A_J * projection_J, A_J is still in cache
+				cblas_dgemv(CblasColMajor, CblasNoTrans, m, columns, 1.0, tile, m, projection + j, 1, j == 0 ? 0.0 : 1.0, gradient, 1);
+			}
+		}
+		//gradient = -b + gradient
+		cblas_daxpby(m, -1.0, problem.b, 1, 1.0, gradient, 1);
+		//y = -t * gradient + y
+		cblas_daxpby(m, -t, gradient, 1, 1.0, y, 1);
+	}
+
+	//projection from shadow = A^T * y, then one pass over the row tiles of A
+	//that steps y and leaves A^T * y_+ in shadow
+	static void alm_inner_rows(const Problem &problem, const double_t *x, double_t sigma, double_t t, double_t *y, double_t *projection, double_t *gradient, double_t *shadow)
+	{
+		const int32_t m = problem.m;
+		const int32_t n = problem.n;
+		const double_t *b = problem.b;
+
+		//projection = P_+(x - sigma * (c - shadow))
+		project_shifted(n, x, problem.c, sigma, shadow, projection);
+		//tiles of whole rows that fit in tileBytes, so that A_I^T * y_I reads
+		//A_I from cache. Each tile also passes over projection and shadow, 24n
+		//bytes against the 8n per row of A it saves, so fewer than minTileRows
+		//rows per tile cost more than they save: A is then a single tile, i.e.
+		//the unfused two passes
+		const size_t fitting = tileBytes / (sizeof(double_t) * std::max(n, 1));
+		const int32_t height = fitting < minTileRows ? std::max(m, 1) : (int32_t)std::min<size_t>(fitting, std::max(m, 1));
+		for (int32_t i = 0; i < m; i += height) {
+			const int32_t rows = std::min(height, m - i);
+			const double_t *tile = problem.A + (size_t)i * n;
+			//gradient_I = A_I * projection - b_I
+			cblas_dgemv(CblasRowMajor, CblasNoTrans, rows, n, 1.0, tile, n, projection, 1, 0.0, gradient + i, 1);
+			cblas_daxpy(rows, -1.0, b + i, 1, gradient + i, 1);
+			//y_I = -t * gradient_I + y_I
+			cblas_daxpy(rows, -t, gradient + i, 1, y + i, 1);
+			//shadow += A_I^T * y_I, A_I is still in cache
+			cblas_dgemv(CblasRowMajor, CblasTrans, rows, n, 1.0, tile, n, y + i, 1, i == 0 ? 0.0 : 1.0, shadow, 1);
+		}
+	}
+
+	int32_t alm_inner(const Problem &problem, const double_t *x, double_t sigma, double_t t, int32_t count, double_t tolerance, double_t *y, double_t *projection, double_t *gradient, double_t *shadow)
+	{
+		const bool rowMajor = problem.layout == eROW_MAJOR;
+		CVX_PHASE(eALM_INNER, 0.0, 0.0);
+		int32_t inner = 0;
+		while (inner < count) {
+			//row tiles carry shadow forward, column tiles recompute A^T * y
+			if (rowMajor)
+				alm_inner_rows(problem, x, sigma, t, y, projection, gradient, shadow);
+			else
+				alm_inner_columns(problem, x, sigma, t, y, projection, gradient);
+			++inner;
+			//||\nabla{L}|| = ||gradient||
+			if (cblas_dnrm2(problem.m, gradient, 1) <= tolerance)
+				break;
+		}
+		//A streamed once per iteration for both products, the projections
+		//count themselves
+		CVX_PHASE_COUNT(inner * (2.0 * flops_of_A(problem) + 4.0 * problem.m), inner * (bytes_of_A(problem) + 40.0 * problem.m));
+		if (!rowMajor && inner > 0)
+			multiply_At(problem, 1.0, y, 0.0, shadow);
+		return inner;
+	}
+
+	int32_t alm_inner_accelerated(const Problem &problem, const double_t *x, double_t sigma, double_t t, int32_t count, double_t tolerance, double_t *y, double_t *projection, double_t *gradient, double_t *shadow, double_t *point, double_t *pointShadow)
+	{
+		const int32_t m = problem.m;
+		const int32_t n = problem.n;
+		const bool rowMajor = problem.layout == eROW_MAJOR;
+		CVX_PHASE(eALM_INNER, 0.0, 0.0);
+
+		//start at point = y without momentum
+		cblas_dcopy(m, y, 1, point, 1);
+		if (rowMajor)
+			cblas_dcopy(n, shadow, 1, pointShadow, 1);
+		double_t theta = 1.0;
+		int32_t inner = 0;
+		while (inner < count) {
+			//gradient at point, point = point - t * gradient
+			if (rowMajor)
+				alm_inner_rows(problem, x, sigma, t, point, projection, gradient, pointShadow);
+			else
+				alm_inner_columns(problem, x, sigma, t, point, projection, gradient);
+			++inner;
+
+			//restart when the step went uphill: gradient^T * (y_+ - y) > 0
+			double_t ascent = 0.0;
+			for (int32_t i = 0; i < m; ++i) {
+				ascent += gradient[i] * (point[i] - y[i]);
+			}
+			double_t beta = 0.0;
+			if (ascent > 0.0) {
+				theta = 1.0;
+			}
+			else {
+				double_t next = 0.5 * (1.0 + std::sqrt(1.0 + 4.0 * theta * theta));
+				beta = (theta - 1.0) / next;
+				theta = next;
+			}
+
+			//y = point, point = y + beta * (y - y_old)
+			for (int32_t i = 0; i < m; ++i) {
+				double_t stepped = point[i];
+				point[i] = stepped + beta * (stepped - y[i]);
+				y[i] = stepped;
+			}
+			//the same combination of A^T * y, so the next pass needs no product
+			if (rowMajor) {
+				for (int32_t j = 0; j < n; ++j) {
+					double_t stepped = pointShadow[j];
+					pointShadow[j] = stepped + beta * (stepped - shadow[j]);
+					shadow[j] = stepped;
+				}
+			}
+
+			//||\nabla{L}|| = ||gradient||
+			if (cblas_dnrm2(m, gradient, 1) <= tolerance)
+				break;
+		}
+		//A streamed once per iteration, plus the momentum updates of point and
+		//pointShadow; the projections count themselves
+		CVX_PHASE_COUNT(inner * (2.0 * flops_of_A(problem) + 10.0 * m + 3.0 * n), inner * (bytes_of_A(problem) + 72.0 * m + 32.0 * n));
+		if (!rowMajor && inner > 0)
+			multiply_At(problem, 1.0, y, 0.0, shadow);
+		return inner;
+	}
+
+	void multiply_A(const Problem &problem, double_t alpha, const double_t *v, double_t beta, double_t *out)
+	{
+		CVX_PHASE(eMULTIPLY, flops_of_A(problem), bytes_of_A(problem) + 8.0 * (problem.n + problem.m));
+		if (problem.is_sparse())
+			return problem.sparse->multiply(alpha, v, beta, out);
+		cblas_dgemv(problem.order(), CblasNoTrans, problem.m, problem.n, alpha, problem.A, problem.lda(), v, 1, beta, out, 1);
+	}
+
+	void multiply_At(const Problem &problem, double_t alpha, const double_t *v, double_t beta, double_t *out)
+	{
+		CVX_PHASE(eMULTIPLY, flops_of_A(problem), bytes_of_A(problem) + 8.0 * (problem.n + problem.m));
+		if (problem.is_sparse())
+			return problem.sparse->multiply_transpose(alpha, v, beta, out);
+		cblas_dgemv(problem.order(), CblasTrans, problem.m, problem.n, alpha, problem.A, problem.lda(), v, 1, beta, out, 1);
+	}
+
+	void multiply_A_block(const Problem &problem, int32_t count, double_t alpha, const double_t *V, int32_t ldv, double_t beta, double_t *out, int32_t ldo)
+	{
+		CVX_PHASE(eMULTIPLY, count * flops_of_A(problem), bytes_of_A(problem) + 8.0 * count * (problem.n + problem.m));
+		if (problem.is_sparse())
+			return problem.sparse->multiply_block(count, alpha, V, ldv, beta, out, ldo);
+		//row-major A is A^T in column-major terms
+		CBLAS_TRANSPOSE op = problem.layout == eROW_MAJOR ? CblasTrans : CblasNoTrans;
+		cblas_dgemm(CblasColMajor, op, CblasNoTrans, problem.m, count, problem.n, alpha, problem.A, problem.lda(), V, ldv, beta, out, ldo);
+	}
+
+	void multiply_At_block(const Problem &problem, int32_t count, double_t alpha, const double_t *V, int32_t ldv, double_t beta, double_t *out, int32_t ldo)
+	{
+		CVX_PHASE(eMULTIPLY, count * flops_of_A(problem), bytes_of_A(problem) + 8.0 * count * (problem.n + problem.m));
+		if (problem.is_sparse())
+			return problem.sparse->multiply_transpose_block(count, alpha, V, ldv, beta, out, ldo);
+		CBLAS_TRANSPOSE op = problem.layout == eROW_MAJOR ? CblasNoTrans : CblasTrans;
+		cblas_dgemm(CblasColMajor, op, CblasNoTrans, problem.n, count, problem.m, alpha, problem.A, problem.lda(), V, ldv, beta, out, ldo);
+	}
+
+	void gram(const Problem &problem, double_t alpha, double_t beta, double_t *out)
+	{
+		const int32_t m = problem.m;
+		CVX_PHASE(eGRAM, flops_of_gram(problem, nullptr, problem.n), bytes_of_A(problem) + 8.0 * m * m);
+		if (problem.is_sparse())
+			return problem.sparse->gram(nullptr, problem.n, alpha, beta, out);
+		//symmetric rank-k update of the upper triangle, then mirror it
+		cblas_dsyrk(problem.order(), CblasUpper, CblasNoTrans, m, problem.n, alpha, problem.A, problem.lda(), beta, out, m);
+		symmetrize_upper(m, out, problem.order() == CblasRowMajor);
+	}
+
+	void gram_columns(const Problem &problem, const int32_t *columns, int32_t count, double_t alpha, double_t beta, double_t *out, std::vector<double_t> &gathered)
+	{
+		const int32_t m = problem.m;
+		const int32_t n = problem.n;
+		//dense A_J is gathered, then read once more
+		CVX_PHASE(eGRAM, flops_of_gram(problem, columns, count), (problem.is_sparse() ? bytes_of_A(problem) : 24.0 * m * count) + 8.0 * m * m);
+		if (problem.is_sparse())
+			return problem.sparse->gram(columns, count, alpha, beta, out);
+
+		//gathered = A_J, m x count in the layout of A
+		gathered.resize((size_t)m * std::max(count, 1));
+		const double_t *A = problem.A;
+		if (problem.layout == eROW_MAJOR) {
+			for (int32_t i = 0; i < m; ++i) {
+				const double_t *row = A + (size_t)i * n;
+				double_t *target = gathered.data() + (size_t)i * count;
+				for (int32_t k = 0; k < count; ++k) {
+					target[k] = row[columns[k]];
+				}
+			}
+		}
+		else {
+			for (int32_t k = 0; k < count; ++k) {
+				cblas_dcopy(m, A + (size_t)columns[k] * m, 1, gathered.data() + (size_t)k * m, 1);
+			}
+		}
+
+		const int32_t ld = problem.layout == eROW_MAJOR ? std::max(count, 1) : m;
+		cblas_dsyrk(problem.order(), CblasUpper, CblasNoTrans, m, count, alpha, gathered.data(), ld, beta, out, m);
+		symmetrize_upper(m, out, problem.order() == CblasRowMajor);
+	}
+
+	void column_of_A(const Problem &problem, int32_t j, double_t alpha, double_t *out)
+	{
+		if (problem.is_sparse())
+			return problem.sparse->column(j, alpha, out);
+		if (problem.layout == eROW_MAJOR)
+			cblas_daxpby(problem.m, alpha, problem.A + j, problem.n, 0.0, out, 1);
+		else
+			cblas_daxpby(problem.m, alpha, problem.A + (size_t)j * problem.m, 1, 0.0, out, 1);
+	}
+
+	int32_t active_changes(const int32_t *previous, int32_t previousCount, const int32_t *current, int32_t currentCount, int32_t limit, int32_t *changed)
+	{
+		int32_t count = 0;
+		int32_t p = 0;
+		int32_t q = 0;
+		while ((p < previousCount || q < currentCount) && count <= limit) {
+			if (q == currentCount || (p < previousCount && previous[p] < current[q])) {
+				changed[count++] = ~previous[p++];
+			}
+			else if (p == previousCount || current[q] < previous[p]) {
+				changed[count++] = current[q++];
+			}
+			else {
+				++p;
+				++q;
+			}
+		}
+		return count;
+	}
+
+	void symmetrize_upper(int32_t m, double_t *out, bool rowMajor)
+	{
+		for (int32_t i = 0; i < m; ++i) {
+			for (int32_t j = 0; j < i; ++j) {
+				//(i, j) is in the lower triangle, copy (j, i)
+				if (rowMajor)
+					out[(size_t)i*m + j] = out[(size_t)j*m + i];
+				else
+					out[(size_t)j*m + i] = out[(size_t)i*m + j];
+			}
+		}
+	}
+
+	void shifted_dual_residual(const Problem &problem, const double_t *x, const double_t *aty, double_t sigma, double_t *projection)
+	{
+		const int32_t n = problem.n;
+		CVX_PHASE(ePROJECTION, 3.0 * n, 48.0 * n);
+		//projection = c - aty
+		cblas_dcopy(n, problem.c, 1, projection, 1);
+		cblas_daxpy(n, -1.0, aty, 1, projection, 1);
+		//projection = x -sigma * projection
+		cblas_daxpby(n, 1.0, x, 1, -sigma, projection, 1);
+	}
+
+	double_t estimate_norm(const Problem &problem, int32_t count, double_t tolerance, uint64_t seed)
+	{
+		const int32_t m = problem.m;
+		const int32_t n = problem.n;
+		//the products count into this phase
+		CVX_PHASE(eNORM, 0.0, 0.0);
+		Workspace workspace;
+		double_t *v = workspace.vector(n);
+		double_t *w = workspace.vector(m);
+
+		std::mt19937_64 generator(seed);
+		std::uniform_real_distribution<double_t> uniform(-1.0, 1.0);
+		for (int32_t j = 0; j < n; ++j) {
+			v[j] = uniform(generator);
+		}
+		double_t length = cblas_dnrm2(n, v, 1);
+		double_t estimate = 0.0;
+		for (int32_t k = 0; k < count && length > 0.0; ++k) {
+			//w = A * v / ||v||, ||w|| <= ||A||_2
+			multiply_A(problem, 1.0 / length, v, 0.0, w);
+			double_t previous = estimate;
+			estimate = cblas_dnrm2(m, w, 1);
+			if (std::abs(estimate - previous) <= tolerance * estimate)
+				break;
+			//v = A^T * w
+			multiply_At(problem, 1.0, w, 0.0, v);
+			length = cblas_dnrm2(n, v, 1);
+		}
+		return estimate;
+	}
+
+	double_t penalty_scale(const Problem &problem, double_t norm)
+	{
+		double_t scale = cblas_dnrm2(problem.m, problem.b, 1) / (norm * cblas_dnrm2(problem.n, problem.c, 1));
+		return std::isfinite(scale) && scale > 0.0 ? scale : 1.0;
+	}
+
+	double_t primal_objective(const Problem &problem, const double_t *x)
+	{
+		CVX_PHASE(eRESIDUALS, 2.0 * problem.n, 16.0 * problem.n);
+		return cblas_ddot(problem.n, problem.c, 1, x, 1);
+	}
+
+	double_t dual_objective(const Problem &problem, const double_t *y)
+	{
+		CVX_PHASE(eRESIDUALS, 2.0 * problem.m, 16.0 * problem.m);
+		return -cblas_ddot(problem.m, problem.b, 1, y, 1);
+	}
+
+	double_t primal_infeasibility(const Problem &problem, const double_t *residual)
+	{
+		CVX_PHASE(eRESIDUALS, 4.0 * problem.m, 16.0 * problem.m);
+		return cblas_dnrm2(problem.m, residual, 1) / (1.0 + cblas_dnrm2(problem.m, problem.b, 1));
+	}
+
+	double_t dual_infeasibility(const Problem &problem, const double_t *aty)
+	{
+		CVX_PHASE(eRESIDUALS, 4.0 * problem.n, 24.0 * problem.n);
+		const double_t *c = problem.c;
+		double_t squared = 0.0;
+		for (int32_t j = 0; j < problem.n; ++j) {
+			double_t violation = aty[j] - c[j];
+			if (violation > 0.0)
+				squared += violation * violation;
+		}
+		return std::sqrt(squared) / (1.0 + cblas_dnrm2(problem.n, c, 1));
+	}
+
+	double_t relative_gap(double_t primal, double_t dual)
+	{
+		return std::abs(primal + dual) / (1.0 + std::abs(primal) + std::abs(dual));
+	}
+
+	void initial_iterate(const std::vector<double_t> *start, double_t *v, int32_t count)
+	{
+		bool usable = start != nullptr && (int32_t)start->size() == count;
+		for (int32_t i = 0; i < count; ++i) {
+			v[i] = usable ? (*start)[i] : 0.0;
+		}
+	}
+}
@@ -0,0 +1,87 @@
+#ifndef _CVX_KERNELS_HPP_
+#define _CVX_KERNELS_HPP_
+
+#include "problem.hpp"
+#include "projection.hpp"
+
+// Kernels shared by all engines. Anything that touches A goes through here so
+// a faster implementation speeds up every solver at once.
+
+namespace cvx
+{
+	// out = alpha * A * v + beta * out
+	void multiply_A(const Problem &problem, double_t alpha, const double_t *v, double_t beta, double_t *out);
+	// out = alpha * A^T * v + beta * out
+	void multiply_At(const Problem &problem, double_t alpha, const double_t *v, double_t beta, double_t *out);
+
+	// multiply_A and multiply_At for count vectors at once, one pass over A:
+	// V and out are column-major blocks with leading dimensions ldv and ldo
+	// (n x count and m x count for multiply_A, the other way round for
+	// multiply_At); dense A is a dgemm
+	void multiply_A_block(const Problem &problem, int32_t count, double_t alpha, const double_t *V, int32_t ldv, double_t beta, double_t *out, int32_t ldo);
+	void multiply_At_block(const Problem &problem, int32_t count, double_t alpha, const double_t *V, int32_t ldv, double_t beta, double_t *out, int32_t ldo);
+
+	// out = alpha * A * A^T + beta * out, out is m x m and filled completely
+	void gram(const Problem &problem, double_t alpha, double_t beta, double_t *out);
+	// out = alpha * A_J * A_J^T + beta * out for the columns J, out is m x m and
+	// filled completely; dense A gathers A_J into gathered (m x count) first
+	void gram_columns(const Problem &problem, const int32_t *columns, int32_t count, double_t alpha, double_t beta, double_t *out, std::vector<double_t> &gathered);
+	// out = alpha * a_j, column j of A as a dense m-vector
+	void column_of_A(const Problem &problem, int32_t j, double_t alpha, double_t *out);
+	// symmetric difference of two ascending index lists: indices only in
+	// current go to changed as j, indices only in previous as ~j; stops and
+	// returns limit + 1 once more than limit indices differ
+	int32_t active_changes(const int32_t *previous, int32_t previousCount, const int32_t *current, int32_t currentCount, int32_t limit, int32_t *changed);
+	// copies the upper triangle of the m x m matrix out onto its lower one
+	void symmetrize_upper(int32_t m, double_t *out, bool rowMajor = true);
+
+	// projection = x - sigma * (c - aty), aty = A^T * y, not yet projected to R+
+	void shifted_dual_residual(const Problem &problem, const double_t *x, const double_t *aty, double_t sigma, double_t *projection);
+
+	// at most count iterations of the ALM inner loop
+	//   projection = P_+(x - sigma * (c - A^T * y))
+	//   gradient = A * projection - b
+	//   y = y - t * gradient
+	// with a single pass over A per iteration, stopping early once
+	// ||gradient|| <= tolerance; returns the iterations run. Column-major and
+	// sparse A fuse A^T * y, the projection and A * projection per column tile;
+	// row-major A fuses A * projection of one iteration with A^T * y of the
+	// next per row tile. shadow (n) must hold A^T * y on entry and holds it
+	// again on return.
+	int32_t alm_inner(const Problem &problem, const double_t *x, double_t sigma, double_t t, int32_t count, double_t tolerance, double_t *y, double_t *projection, double_t *gradient, double_t *shadow);
+	// alm_inner with Nesterov momentum (FISTA): the gradient is taken at the
+	// extrapolated point (m) and the momentum restarts whenever a step goes
+	// uphill. A^T * point is extrapolated in pointShadow (n) alongside point,
+	// so an iteration still costs one pass over A.
+	int32_t alm_inner_accelerated(const Problem &problem, const double_t *x, double_t sigma, double_t t, int32_t count, double_t tolerance, double_t *y, double_t *projection, double_t *gradient, double_t *shadow, double_t *point, double_t *pointShadow);
+
+	// sigma_max(A) by power iteration on A^T * A from a seeded random start:
+	// at most count products with A and A^T each, stopping once the estimate
+	// moves by less than tolerance relative. The estimate is a lower bound
+	// that approaches ||A||_2 from below, and it can stop well short of it
+	// when the top singular values are close; a step that needs an upper
+	// bound has to add a margin.
+	double_t estimate_norm(const Problem &problem, int32_t count = 50, double_t tolerance = 1e-6, uint64_t seed = 1);
+
+	// ||b|| / (||A||_2 * ||c||), the size of x (about ||b|| / ||A||_2) per unit
+	// of c: penalties that add t * c to x are scaled by it. 1 if b or c is 0.
+	double_t penalty_scale(const Problem &problem, double_t norm);
+
+	// c^T * x
+	double_t primal_objective(const Problem &problem, const double_t *x);
+	// -b^T * y
+	double_t dual_objective(const Problem &problem, const double_t *y);
+
+	// scaled residuals (see Residuals) from products the engines already hold
+	// ||residual|| / (1 + ||b||), residual = A * x - b
+	double_t primal_infeasibility(const Problem &problem, const double_t *residual);
+	// ||(aty - c)_+|| / (1 + ||c||), aty = A^T * y
+	double_t dual_infeasibility(const Problem &problem, const double_t *aty);
+	// |primal + dual| / (1 + |primal| + |dual|) of the objectives above
+	double_t relative_gap(double_t primal, double_t dual);
+
+	// v = start when it has count entries, otherwise v = 0
+	void initial_iterate(const std::vector<double_t> *start, double_t *v, int32_t count);
+}
+
+#endif /*!_CVX_KERNELS_HPP_*/
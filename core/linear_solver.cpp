@@ -0,0 +1,197 @@
+#include <algorithm>
+#include <cmath>
+#include "linear_solver.hpp"
+#include "problem.hpp"
+#include "profile.hpp"
+
+namespace cvx {
+
+	//the row-major upper triangle is the column-major lower one
+	const static char uplo = 'L';
+
+	SpdSolver::SpdSolver(void) : _m(0), _method(eNONE), _workSize(0) {}
+
+	void SpdSolver::factor(const double_t *matrix, int32_t m)
+	{
+		CVX_PHASE(eFACTOR, (double_t)m * m * m / 3.0, 24.0 * m * m);
+		const blas_int order = m;
+		blas_int info;
+		const size_t size = (size_t)m * m;
+
+		_m = m;
+		_method = eNONE;
+		_factor.assign(matrix, matrix + size);
+		dpotrf(&uplo, &order, _factor.data(), &order, &info);
+		if (info < 0)
+			throw Error("dpotrf: argument " + std::to_string(-info) + " is invalid");
+		if (info == 0) {
+			_method = eCHOLESKY;
+			return;
+		}
+
+		//not positive definite, dpotrf overwrote part of the copy
+		_factor.assign(matrix, matrix + size);
+		_ipiv.resize(m);
+		if (_workSize != m) {
+			blas_int query = -1;
+			double_t optimal;
+			dsytrf(&uplo, &order, _factor.data(), &order, _ipiv.data(), &optimal, &query, &info);
+			if (info != 0)
+				throw Error("dsytrf workspace query failed with info " + std::to_string(info));
+			_work.resize(std::max<size_t>(1, (size_t)optimal));
+			_workSize = m;
+		}
+		blas_int lwork = (blas_int)_work.size();
+		dsytrf(&uplo, &order, _factor.data(), &order, _ipiv.data(), _work.data(), &lwork, &info);
+		if (info < 0)
+			throw Error("dsytrf: argument " + std::to_string(-info) + " is invalid");
+		if (info > 0)
+			throw Error("dsytrf: system is singular at pivot " + std::to_string(info));
+		_method = eLDLT;
+	}
+
+	bool SpdSolver::rank_one(double_t *v, double_t sign)
+	{
+		if (_method != eCHOLESKY)
+			return false;
+		CVX_PHASE(eFACTOR, 6.0 * _m * _m, 16.0 * _m * _m);
+
+		//column k of the column-major lower factor is contiguous
+		for (int32_t k = 0; k < _m; ++k) {
+			double_t *column = _factor.data() + (size_t)k * _m;
+			double_t diagonal = column[k];
+			double_t squared = diagonal * diagonal + sign * v[k] * v[k];
+			if (!(squared > 0.0)) {
+				_method = eNONE;
+				return false;
+			}
+			double_t r = std::sqrt(squared);
+			double_t cosine = r / diagonal;
+			double_t sine = v[k] / diagonal;
+			column[k] = r;
+			for (int32_t i = k + 1; i < _m; ++i) {
+				column[i] = (column[i] + sign * sine * v[i]) / cosine;
+				v[i] = cosine * v[i] - sine * column[i];
+			}
+		}
+		return true;
+	}
+
+	void SpdSolver::solve(double_t *rhs) const
+	{
+		CVX_PHASE(eSOLVE, 2.0 * _m * _m, 8.0 * _m * _m + 16.0 * _m);
+		const blas_int order = _m;
+		const blas_int nrhs = 1;
+		blas_int info = 0;
+
+		switch (_method) {
+		case eCHOLESKY:
+			dpotrs(&uplo, &order, &nrhs, _factor.data(), &order, rhs, &order, &info);
+			break;
+		case eLDLT:
+			dsytrs(&uplo, &order, &nrhs, _factor.data(), &order, _ipiv.data(), rhs, &order, &info);
+			break;
+		default:
+			throw Error("solve called before factor");
+		}
+		if (info != 0)
+			throw Error("triangular solve failed with info " + std::to_string(info));
+	}
+
+	SpectralSolver::SpectralSolver(void) : _m(0) {}
+
+	void SpectralSolver::decompose(const double_t *matrix, int32_t m)
+	{
+		//dsyev with eigenvectors, about 9 m^3 flops
+		CVX_PHASE(eFACTOR, 9.0 * m * m * m, 24.0 * m * m);
+		const char jobz = 'V';
+		const blas_int order = m;
+		blas_int info;
+
+		_m = m;
+		_vectors.assign(matrix, matrix + (size_t)m * m);
+		_values.resize(m);
+		_inverse.clear();
+		_projected.resize(m);
+
+		blas_int query = -1;
+		double_t optimal;
+		dsyev(&jobz, &uplo, &order, _vectors.data(), &order, _values.data(), &optimal, &query, &info);
+		if (info != 0)
+			throw Error("dsyev workspace query failed with info " + std::to_string(info));
+		std::vector<double_t> work(std::max<size_t>(1, (size_t)optimal));
+		blas_int lwork = (blas_int)work.size();
+		dsyev(&jobz, &uplo, &order, _vectors.data(), &order, _values.data(), work.data(), &lwork, &info);
+		if (info < 0)
+			throw Error("dsyev: argument " + std::to_string(-info) + " is invalid");
+		if (info > 0)
+			throw Error("dsyev: " + std::to_string(info) + " eigenvalues failed to converge");
+		//G is semidefinite, the tiny negative values are rounding
+		for (double_t &value : _values) {
+			value = std::max(value, 0.0);
+		}
+	}
+
+	void SpectralSolver::set_shift(double_t scale, double_t shift)
+	{
+		_inverse.resize(_m);
+		for (int32_t i = 0; i < _m; ++i) {
+			double_t diagonal = scale * _values[i] + shift;
+			if (!(diagonal > 0.0))
+				throw Error("scale * G + shift * I is not positive definite");
+			_inverse[i] = 1.0 / diagonal;
+		}
+	}
+
+	int32_t SpectralSolver::set_pseudo_inverse(double_t tolerance)
+	{
+		double_t largest = 0.0;
+		for (double_t value : _values) {
+			largest = std::max(largest, value);
+		}
+		int32_t rank = 0;
+		_inverse.resize(_m);
+		for (int32_t i = 0; i < _m; ++i) {
+			bool kept = _values[i] > tolerance * largest;
+			_inverse[i] = kept ? 1.0 / _values[i] : 0.0;
+			rank += kept;
+		}
+		return rank;
+	}
+
+	void SpectralSolver::solve(double_t *rhs) const
+	{
+		CVX_PHASE(eSOLVE, 4.0 * _m * _m, 16.0 * _m * _m + 32.0 * _m);
+		if (_inverse.size() != (size_t)_m)
+			throw Error("SpectralSolver::solve before decompose and set_shift");
+		//projected = L^-1 * Q^T * rhs
+		cblas_dgemv(CblasColMajor, CblasTrans, _m, _m, 1.0, _vectors.data(), _m, rhs, 1, 0.0, _projected.data(), 1);
+		for (int32_t i = 0; i < _m; ++i) {
+			_projected[i] *= _inverse[i];
+		}
+		//rhs = Q * projected
+		cblas_dgemv(CblasColMajor, CblasNoTrans, _m, _m, 1.0, _vectors.data(), _m, _projected.data(), 1, 0.0, rhs, 1);
+	}
+
+	void SpectralSolver::solve(double_t *rhs, int32_t ld, int32_t count, const double_t *scales, const double_t *shifts) const
+	{
+		CVX_PHASE(eSOLVE, 4.0 * _m * _m * count, 16.0 * _m * _m + 32.0 * _m * count);
+		if (_values.size() != (size_t)_m || _m == 0)
+			throw Error("SpectralSolver::solve before decompose");
+		_projected.resize((size_t)_m * count);
+		//projected = Q^T * rhs
+		cblas_dgemm(CblasColMajor, CblasTrans, CblasNoTrans, _m, count, _m, 1.0, _vectors.data(), _m, rhs, ld, 0.0, _projected.data(), _m);
+		//column j of projected times (scales[j] * L + shifts[j] * I)^-1
+		for (int32_t j = 0; j < count; ++j) {
+			double_t *column = _projected.data() + (size_t)j * _m;
+			for (int32_t i = 0; i < _m; ++i) {
+				double_t diagonal = scales[j] * _values[i] + shifts[j];
+				if (!(diagonal > 0.0))
+					throw Error("scale * G + shift * I is not positive definite");
+				column[i] /= diagonal;
+			}
+		}
+		//rhs = Q * projected
+		cblas_dgemm(CblasColMajor, CblasNoTrans, CblasNoTrans, _m, count, _m, 1.0, _vectors.data(), _m, _projected.data(), _m, 0.0, rhs, ld);
+	}
+}
@@ -0,0 +1,90 @@
+#ifndef _CVX_LINEAR_SOLVER_HPP_
+#define _CVX_LINEAR_SOLVER_HPP_
+
+#include <vector>
+#include "blas.hpp"
+
+namespace cvx
+{
+	// Factor-and-solve for symmetric (normally positive definite) m x m systems.
+	// factor() runs Cholesky (dpotrf); when the matrix turns out not to be
+	// positive definite it falls back to a Bunch-Kaufman LDL^T (dsytrf) whose
+	// workspace is queried once per size. solve() is then triangular solves
+	// against the cached factor, no explicit inverse is ever formed. Every
+	// LAPACK info code is checked and reported through Error.
+	class SpdSolver
+	{
+	public:
+		enum Method {
+			eNONE = 0,
+			eCHOLESKY = 1,
+			eLDLT = 2
+		};
+
+	public:
+		SpdSolver(void);
+
+	public:
+		// matrix is m x m, symmetric and stored completely; it is copied
+		void factor(const double_t *matrix, int32_t m);
+		// rhs = matrix^-1 * rhs
+		void solve(double_t *rhs) const;
+		// turns the Cholesky factor of matrix into that of matrix + sign * v * v^T
+		// in O(m^2), v is overwritten. Returns false and drops the factor when
+		// there is no Cholesky factor or the downdate loses definiteness; the
+		// caller then has to factor() again
+		bool rank_one(double_t *v, double_t sign);
+		bool factored(void) const { return _method != eNONE; }
+		Method method(void) const { return _method; }
+		int32_t size(void) const { return _m; }
+
+	private:
+		int32_t _m;
+		Method _method;
+		std::vector<double_t> _factor;
+		std::vector<blas_int> _ipiv;
+		std::vector<double_t> _work;
+		// size _work was queried for
+		int32_t _workSize;
+	};
+
+	// Solver for the family (scale * G + shift * I) * v = rhs of a symmetric
+	// positive semidefinite m x m matrix G. decompose() computes G = Q * L * Q^T
+	// once (dsyev, O(m^3)); set_shift() then picks a member of the family in
+	// O(m) and solve() costs two m x m products, so a penalty that changes
+	// between iterations never refactors.
+	class SpectralSolver
+	{
+	public:
+		SpectralSolver(void);
+
+	public:
+		// matrix is m x m, symmetric and stored completely; it is copied
+		void decompose(const double_t *matrix, int32_t m);
+		// selects scale * G + shift * I, which has to be positive definite
+		void set_shift(double_t scale, double_t shift);
+		// selects the pseudo-inverse G^+ instead: eigenvalues at or below
+		// tolerance * the largest one count as zero, so a singular G (A with a
+		// zero or dependent row) is fine; returns the rank kept
+		int32_t set_pseudo_inverse(double_t tolerance);
+		// rhs = (scale * G + shift * I)^-1 * rhs, or G^+ * rhs
+		void solve(double_t *rhs) const;
+		// count right-hand sides at once, column j of rhs (column-major, leading
+		// dimension ld) solved with scales[j] * G + shifts[j] * I; two m x m x
+		// count products whatever the shifts, set_shift is not needed
+		void solve(double_t *rhs, int32_t ld, int32_t count, const double_t *scales, const double_t *shifts) const;
+		int32_t size(void) const { return _m; }
+
+	private:
+		int32_t _m;
+		// eigenvectors, column-major
+		std::vector<double_t> _vectors;
+		std::vector<double_t> _values;
+		// 1 / (scale * values + shift)
+		std::vector<double_t> _inverse;
+		// Q^T * rhs, m x count
+		mutable std::vector<double_t> _projected;
+	};
+}
+
+#endif /*!_CVX_LINEAR_SOLVER_HPP_*/
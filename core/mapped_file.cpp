@@ -0,0 +1,61 @@
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "mapped_file.hpp"
+#include "problem.hpp"
+
+namespace cvx {
+
+	MappedFile::MappedFile(const std::string &path, bool writable)
+		: _path(path), _data(nullptr), _size(0)
+	{
+		int fd = open(path.c_str(), O_RDONLY);
+		if (fd < 0)
+			throw Error(std::string("Failed to open ").append(path));
+
+		struct stat info;
+		if (fstat(fd, &info) != 0) {
+			close(fd);
+			throw Error(std::string("Failed to stat ").append(path));
+		}
+
+		_size = info.st_size;
+		if (_size > 0) {
+			int protection = writable ? PROT_READ | PROT_WRITE : PROT_READ;
+			void *data = mmap(nullptr, _size, protection, MAP_PRIVATE, fd, 0);
+			if (data == MAP_FAILED) {
+				close(fd);
+				throw Error(std::string("Failed to map ").append(path));
+			}
+			_data = (char*)data;
+		}
+		close(fd);
+	}
+
+	MappedFile::~MappedFile(void)
+	{
+		if (_data != nullptr)
+			munmap(_data, _size);
+	}
+
+	void MappedFile::advise(size_t offset, size_t bytes, int advice) const
+	{
+		if (_data == nullptr || bytes == 0)
+			return;
+		//madvise wants a page aligned start
+		size_t page = sysconf(_SC_PAGESIZE);
+		size_t start = offset / page * page;
+		madvise(_data + start, offset + bytes - start, advice);
+	}
+
+	void MappedFile::prefetch(size_t offset, size_t bytes) const
+	{
+		advise(offset, bytes, MADV_WILLNEED);
+	}
+
+	void MappedFile::sequential(size_t offset, size_t bytes) const
+	{
+		advise(offset, bytes, MADV_SEQUENTIAL);
+	}
+}
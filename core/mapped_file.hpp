@@ -0,0 +1,38 @@
+#ifndef _CVX_MAPPED_FILE_HPP_
+#define _CVX_MAPPED_FILE_HPP_
+
+#include <string>
+#include "blas.hpp"
+
+namespace cvx
+{
+	// Private memory map of a whole file, unmapped on destruction.
+	// A writable mapping is copy-on-write and never touches the file.
+	class MappedFile
+	{
+	public:
+		MappedFile(const std::string &path, bool writable = false);
+		~MappedFile(void);
+		MappedFile(const MappedFile &) = delete;
+		MappedFile &operator=(const MappedFile &) = delete;
+
+	public:
+		char *data(void) const { return _data; }
+		size_t size(void) const { return _size; }
+		const std::string &path(void) const { return _path; }
+		// hint that the range will be read soon
+		void prefetch(size_t offset, size_t bytes) const;
+		// hint that the range is read once front to back
+		void sequential(size_t offset, size_t bytes) const;
+
+	private:
+		void advise(size_t offset, size_t bytes, int advice) const;
+
+	private:
+		std::string _path;
+		char *_data;
+		size_t _size;
+	};
+}
+
+#endif /*!_CVX_MAPPED_FILE_HPP_*/
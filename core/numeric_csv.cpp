@@ -0,0 +1,147 @@
+#include <charconv>
+#include <cstring>
+#include <thread>
+#include "numeric_csv.hpp"
+#include "parallel.hpp"
+#include "problem.hpp"
+
+namespace cvx {
+
+	// ranges smaller than this are not worth a thread
+	const static size_t minChunkBytes = 1 << 20;
+
+	static bool is_blank(char ch)
+	{
+		return ch == ' ' || ch == '\t' || ch == '\r';
+	}
+
+	// [begin, end) of the next line, trailing \r stripped; returns the start of the line after
+	static const char *next_line(const char *p, const char *last, const char **end)
+	{
+		const char *eol = p < last ? (const char*)memchr(p, '\n', (size_t)(last - p)) : nullptr;
+		if (eol == nullptr)
+			eol = last;
+		*end = eol;
+		while (*end > p && is_blank((*end)[-1]))
+			--*end;
+		return eol == last ? last : eol + 1;
+	}
+
+	static const char *skip_blanks(const char *p, const char *end)
+	{
+		while (p < end && is_blank(*p))
+			++p;
+		return p;
+	}
+
+	NumericCsv::NumericCsv(const std::string &path, int32_t threads)
+		: _file(path), _rows(0), _cols(0)
+	{
+		const char *first = _file.data();
+		const char *last = first + _file.size();
+		size_t size = _file.size();
+
+		if (threads <= 0)
+			threads = std::max(1u, std::thread::hardware_concurrency());
+		size_t count = std::max<size_t>(1, std::min<size_t>(threads, size / minChunkBytes));
+
+		//split at the first newline after every 1/count of the file
+		const char *begin = first;
+		for (size_t i = 1; i <= count && begin < last; ++i) {
+			const char *end = last;
+			if (i < count) {
+				const char *target = std::max(begin, first + size / count * i);
+				const char *eol = (const char*)memchr(target, '\n', (size_t)(last - target));
+				end = eol == nullptr ? last : eol + 1;
+			}
+			_chunks.push_back(Chunk{ begin, end, 0, 0, 0, 0 });
+			begin = end;
+		}
+		if (_chunks.empty())
+			throw Error(std::string("No Data in ").append(path));
+
+		_file.sequential(0, size);
+		run_parallel(_chunks.size(), [this](size_t i) { count_rows(_chunks[i]); });
+
+		for (Chunk &chunk : _chunks) {
+			chunk.firstRow = _rows;
+			_rows += chunk.rows;
+		}
+		for (size_t i = 1; i < _chunks.size(); ++i) {
+			_chunks[i].firstLine = _chunks[i - 1].firstLine + _chunks[i - 1].lines;
+		}
+		if (_rows == 0)
+			throw Error(std::string("No Data in ").append(path));
+
+		//the first non-blank line fixes the column count
+		for (size_t i = 0; i < _chunks.size() && _cols == 0; ++i) {
+			const char *p = _chunks[i].begin;
+			while (p < _chunks[i].end && _cols == 0) {
+				const char *end;
+				const char *line = skip_blanks(p, _chunks[i].end);
+				p = next_line(line, _chunks[i].end, &end);
+				if (line == end)
+					continue;
+				_cols = 1;
+				for (const char *q = line; q < end; ++q) {
+					if (*q == ',')
+						++_cols;
+				}
+			}
+		}
+	}
+
+	void NumericCsv::count_rows(Chunk &chunk) const
+	{
+		const char *p = chunk.begin;
+		while (p < chunk.end) {
+			const char *end;
+			const char *line = skip_blanks(p, chunk.end);
+			p = next_line(line, chunk.end, &end);
+			++chunk.lines;
+			if (line != end)
+				++chunk.rows;
+		}
+	}
+
+	void NumericCsv::read(double_t *out) const
+	{
+		run_parallel(_chunks.size(), [this, out](size_t i) { parse_rows(_chunks[i], out); });
+	}
+
+	void NumericCsv::parse_rows(const Chunk &chunk, double_t *out) const
+	{
+		const char *p = chunk.begin;
+		size_t row = chunk.firstRow;
+		int32_t lineNumber = chunk.firstLine;
+
+		while (p < chunk.end) {
+			const char *end;
+			const char *line = skip_blanks(p, chunk.end);
+			p = next_line(line, chunk.end, &end);
+			++lineNumber;
+			if (line == end)
+				continue;
+
+			const char *q = line;
+			double_t *values = out + row * _cols;
+			for (int32_t col = 0; col < _cols; ++col) {
+				q = skip_blanks(q, end);
+				if (q < end && *q == '+')
+					++q;
+				std::from_chars_result parsed = std::from_chars(q, end, values[col]);
+				if (parsed.ec != std::errc())
+					throw Error(_file.path() + ":" + std::to_string(lineNumber) + ": field " + std::to_string(col + 1) + " is not a number");
+				q = skip_blanks(parsed.ptr, end);
+				if (col + 1 < _cols) {
+					if (q == end || *q != ',')
+						throw Error(_file.path() + ":" + std::to_string(lineNumber) + ": expected " + std::to_string(_cols) + " fields");
+					++q;
+				}
+			}
+			if (q != end)
+				throw Error(_file.path() + ":" + std::to_string(lineNumber) + ": expected " + std::to_string(_cols) + " fields");
+			++row;
+		}
+	}
+}
@@ -0,0 +1,51 @@
+#ifndef _CVX_NUMERIC_CSV_HPP_
+#define _CVX_NUMERIC_CSV_HPP_
+
+#include <vector>
+#include "mapped_file.hpp"
+
+namespace cvx
+{
+	// Headerless, numeric-only CSV reader.
+	// The file is mapped and split into byte ranges that end on a newline. On
+	// construction every range counts its rows on its own thread, a prefix sum
+	// turns the counts into row offsets, and read() then parses all ranges in
+	// parallel with std::from_chars straight into the caller's buffer: no line
+	// strings, no per-cell allocation.
+	// Blank lines are skipped, fields may be padded with spaces and lines may
+	// end with \r\n.
+	class NumericCsv
+	{
+	public:
+		// threads <= 0 uses every hardware thread
+		NumericCsv(const std::string &path, int32_t threads = 0);
+
+	public:
+		int32_t rows(void) const { return _rows; }
+		int32_t cols(void) const { return _cols; }
+		// out receives rows() x cols() values, row-major
+		void read(double_t *out) const;
+
+	private:
+		struct Chunk
+		{
+			const char *begin;
+			const char *end;
+			int32_t firstRow;
+			int32_t rows;
+			int32_t firstLine;
+			int32_t lines;
+		};
+
+		void count_rows(Chunk &chunk) const;
+		void parse_rows(const Chunk &chunk, double_t *out) const;
+
+	private:
+		MappedFile _file;
+		std::vector<Chunk> _chunks;
+		int32_t _rows;
+		int32_t _cols;
+	};
+}
+
+#endif /*!_CVX_NUMERIC_CSV_HPP_*/
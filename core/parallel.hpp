@@ -0,0 +1,39 @@
+#ifndef _CVX_PARALLEL_HPP_
+#define _CVX_PARALLEL_HPP_
+
+#include <exception>
+#include <thread>
+#include <vector>
+
+// Fork-join helper of the loaders and the generator, internal to the core
+
+namespace cvx
+{
+	// runs work(0) ... work(count - 1), one thread each, the caller takes
+	// index 0; the first exception thrown is rethrown once all have joined.
+	// count == 0 runs nothing
+	template<typename Work>
+	void run_parallel(size_t count, Work work)
+	{
+		if (count == 0)
+			return;
+		std::vector<std::thread> threads;
+		std::vector<std::exception_ptr> errors(count);
+		for (size_t i = 1; i < count; ++i) {
+			threads.emplace_back([&, i]() {
+				try { work(i); }
+				catch (...) { errors[i] = std::current_exception(); }
+			});
+		}
+		try { work(0); }
+		catch (...) { errors[0] = std::current_exception(); }
+		for (std::thread &thread : threads)
+			thread.join();
+		for (std::exception_ptr &error : errors) {
+			if (error)
+				std::rethrow_exception(error);
+		}
+	}
+}
+
+#endif /*!_CVX_PARALLEL_HPP_*/
@@ -0,0 +1,151 @@
+#include <algorithm>
+#include "pool.hpp"
+
+namespace cvx {
+
+	void set_blas_threading(BlasThreading threading)
+	{
+#ifdef CVX_USE_MKL
+		mkl_set_threading_layer(threading == eBLAS_SEQUENTIAL ? MKL_THREADING_SEQUENTIAL : MKL_THREADING_INTEL);
+#else
+		int32_t hardware = std::max(1u, std::thread::hardware_concurrency());
+		openblas_set_num_threads(threading == eBLAS_SEQUENTIAL ? 1 : hardware);
+#endif
+	}
+
+	int32_t set_blas_threads(int32_t count)
+	{
+#ifdef CVX_USE_MKL
+		//0 would fall back to the global setting
+		int32_t previous = mkl_set_num_threads_local(count);
+		return previous == 0 ? mkl_get_max_threads() : previous;
+#else
+		int32_t previous = openblas_get_num_threads();
+		openblas_set_num_threads(count);
+		return previous;
+#endif
+	}
+
+	SolverPool::SolverPool(int32_t workers) :
+		_pending(0), _next(0), _claiming(false), _stopping(false)
+	{
+		if (workers <= 0)
+			workers = std::max(1u, std::thread::hardware_concurrency());
+		_freeCores = workers;
+		for (int32_t i = 0; i < workers; ++i) {
+			_queues.emplace_back(new Queue());
+		}
+		for (int32_t i = 0; i < workers; ++i) {
+			_threads.emplace_back(&SolverPool::work, this, i);
+		}
+	}
+
+	SolverPool::~SolverPool(void)
+	{
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			_stopping = true;
+		}
+		_wake.notify_all();
+		for (std::thread &thread : _threads)
+			thread.join();
+	}
+
+	std::future<void> SolverPool::submit(std::function<void(void)> job, int32_t cores)
+	{
+		Job entry;
+		entry.task = std::packaged_task<void(void)>(std::move(job));
+		entry.cores = std::min(std::max(cores, 1), workers());
+		std::future<void> future = entry.task.get_future();
+
+		int32_t index;
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			index = _next;
+			_next = (_next + 1) % workers();
+		}
+		{
+			std::lock_guard<std::mutex> lock(_queues[index]->mutex);
+			_queues[index]->jobs.push_back(std::move(entry));
+		}
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			++_pending;
+		}
+		_wake.notify_all();
+		return future;
+	}
+
+	bool SolverPool::take(int32_t index, Job &job)
+	{
+		const int32_t count = workers();
+		for (int32_t k = 0; k < count; ++k) {
+			Queue &queue = *_queues[(index + k) % count];
+			std::lock_guard<std::mutex> lock(queue.mutex);
+			if (queue.jobs.empty())
+				continue;
+			if (k == 0) {
+				job = std::move(queue.jobs.front());
+				queue.jobs.pop_front();
+			}
+			else {
+				job = std::move(queue.jobs.back());
+				queue.jobs.pop_back();
+			}
+			return true;
+		}
+		return false;
+	}
+
+	void SolverPool::work(int32_t index)
+	{
+		//sequential BLAS unless a job reserved more; process-wide with OpenBLAS
+		set_blas_threads(1);
+		for (;;) {
+			Job job;
+			{
+				std::unique_lock<std::mutex> lock(_mutex);
+				_wake.wait(lock, [this]() { return _pending > 0 || _stopping; });
+				if (_pending == 0)
+					return;
+				--_pending;
+			}
+			//_pending counted the job before it was queued, so it is there
+			while (!take(index, job))
+				std::this_thread::yield();
+
+			{
+				std::unique_lock<std::mutex> lock(_mutex);
+				if (job.cores > 1) {
+					//stop single-core jobs from starting until the cores are free
+					_wake.wait(lock, [this]() { return !_claiming; });
+					_claiming = true;
+					_wake.wait(lock, [this, &job]() { return _freeCores >= job.cores; });
+					_claiming = false;
+				}
+				else {
+					_wake.wait(lock, [this]() { return _freeCores >= 1 && !_claiming; });
+				}
+				_freeCores -= job.cores;
+			}
+			_wake.notify_all();
+
+#ifdef CVX_USE_MKL
+			//OpenBLAS would hand the cores to every worker at once
+			if (job.cores > 1)
+				set_blas_threads(job.cores);
+#endif
+			job.task();
+#ifdef CVX_USE_MKL
+			if (job.cores > 1)
+				set_blas_threads(1);
+#endif
+
+			{
+				std::lock_guard<std::mutex> lock(_mutex);
+				_freeCores += job.cores;
+			}
+			_wake.notify_all();
+		}
+	}
+}
@@ -0,0 +1,89 @@
+#ifndef _CVX_POOL_HPP_
+#define _CVX_POOL_HPP_
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include "problem.hpp"
+
+// Threading policy
+// A process either runs one solve with a threaded BLAS, or many solves side
+// by side with every BLAS call sequential on the thread that makes it. The
+// two never mix: a job that wants several cores for its BLAS calls reserves
+// them from the pool first, so the total never exceeds the hardware.
+// With MKL the library is linked as mkl_rt and the threading layer is chosen
+// once at run time by set_blas_threading; per-thread counts then come from
+// mkl_set_num_threads_local. OpenBLAS has one process-wide count only, so
+// inside a pool every job runs its BLAS sequentially.
+
+namespace cvx
+{
+	enum BlasThreading {
+		eBLAS_SEQUENTIAL = 0,
+		eBLAS_THREADED = 1
+	};
+
+	// process-wide, before the first BLAS call
+	void set_blas_threading(BlasThreading threading);
+	// threads used by the BLAS calls of the calling thread (process-wide with
+	// OpenBLAS); returns the previous count
+	int32_t set_blas_threads(int32_t count);
+
+	// Fixed set of workers running independent jobs, normally one solve each.
+	// submit() deals jobs round-robin onto per-worker queues; a worker runs
+	// its own queue front to back and, once it is empty, steals from the back
+	// of the others'. Jobs allocate their own workspaces on the worker that
+	// runs them.
+	class SolverPool
+	{
+	public:
+		// workers <= 0 starts one per hardware thread
+		SolverPool(int32_t workers = 0);
+		// runs the jobs still queued, then joins
+		~SolverPool(void);
+		SolverPool(const SolverPool &) = delete;
+		SolverPool &operator=(const SolverPool &) = delete;
+
+	public:
+		// job runs on one worker with cores cores for its BLAS calls (capped at
+		// workers()); no other job starts while those cores are taken, so a
+		// large job waits for them to come free. Exceptions reach the future.
+		std::future<void> submit(std::function<void(void)> job, int32_t cores = 1);
+		int32_t workers(void) const { return (int32_t)_threads.size(); }
+
+	private:
+		struct Job
+		{
+			std::packaged_task<void(void)> task;
+			int32_t cores;
+		};
+		struct Queue
+		{
+			std::mutex mutex;
+			std::deque<Job> jobs;
+		};
+
+		void work(int32_t index);
+		// own queue front first, then the back of every other queue
+		bool take(int32_t index, Job &job);
+
+	private:
+		std::vector<std::thread> _threads;
+		std::vector<std::unique_ptr<Queue>> _queues;
+		// guards everything below, the queues have their own locks
+		std::mutex _mutex;
+		std::condition_variable _wake;
+		int32_t _pending;
+		int32_t _next;
+		int32_t _freeCores;
+		// a multi-core job is waiting for cores, single-core jobs hold back
+		bool _claiming;
+		bool _stopping;
+	};
+}
+
+#endif /*!_CVX_POOL_HPP_*/
@@ -0,0 +1,92 @@
+#include <future>
+#include "problem.hpp"
+#include "binary.hpp"
+#include "sparse.hpp"
+#include "workspace.hpp"
+#include "numeric_csv.hpp"
+
+namespace cvx {
+
+	std::ostream &operator<<(std::ostream &out, const Residuals &residuals)
+	{
+		return out << "primal residual: " << residuals.primal << "\tdual residual: " << residuals.dual << "\tgap: " << residuals.gap;
+	}
+
+	Problem allocate_problem(int32_t m, int32_t n)
+	{
+		std::shared_ptr<Workspace> storage = std::make_shared<Workspace>();
+
+		Problem problem;
+		problem.m = m;
+		problem.n = n;
+		problem.A = storage->vector((size_t)m * n);
+		problem.b = storage->vector(m);
+		problem.c = storage->vector(n);
+		problem.storage = storage;
+		return problem;
+	}
+
+	static std::string join(const std::string &directory, const std::string &file)
+	{
+		if (directory.empty() || directory == ".")
+			return file;
+		if (directory.back() == '/')
+			return directory + file;
+		return directory + "/" + file;
+	}
+
+	Problem load_problem_csv(const std::string &directory, int32_t threads)
+	{
+		auto open = [&directory, threads](const char *name) {
+			return std::make_unique<NumericCsv>(join(directory, name), threads);
+		};
+
+		//scan the three files concurrently, A keeps the calling thread
+		std::future<std::unique_ptr<NumericCsv>> b_scan = std::async(std::launch::async, open, "b.csv");
+		std::future<std::unique_ptr<NumericCsv>> c_scan = std::async(std::launch::async, open, "c.csv");
+		std::unique_ptr<NumericCsv> A_csv = open("A.csv");
+		std::unique_ptr<NumericCsv> b_csv = b_scan.get();
+		std::unique_ptr<NumericCsv> c_csv = c_scan.get();
+		const int32_t m = A_csv->rows();
+		const int32_t n = A_csv->cols();
+
+		if (b_csv->rows() != m || b_csv->cols() != 1)
+			throw Error("b.csv must be a column of " + std::to_string(m) + " values");
+		if (c_csv->rows() != n || c_csv->cols() != 1)
+			throw Error("c.csv must be a column of " + std::to_string(n) + " values");
+
+		Problem problem = allocate_problem(m, n);
+		std::future<void> b_read = std::async(std::launch::async, [&]() { b_csv->read(problem.b); });
+		std::future<void> c_read = std::async(std::launch::async, [&]() { c_csv->read(problem.c); });
+		A_csv->read(problem.A);
+		b_read.get();
+		c_read.get();
+		return problem;
+	}
+
+	Problem make_sparse(const Problem &problem)
+	{
+		if (problem.is_sparse())
+			return problem;
+
+		std::shared_ptr<Workspace> storage = std::make_shared<Workspace>();
+		Problem sparse;
+		sparse.m = problem.m;
+		sparse.n = problem.n;
+		sparse.layout = eCSR;
+		sparse.sparse = SparseMatrix::from_dense(problem.m, problem.n, problem.A, problem.layout == eROW_MAJOR, problem.lda());
+		sparse.b = storage->vector(problem.m);
+		sparse.c = storage->vector(problem.n);
+		cblas_dcopy(problem.m, problem.b, 1, sparse.b, 1);
+		cblas_dcopy(problem.n, problem.c, 1, sparse.c, 1);
+		sparse.storage = storage;
+		return sparse;
+	}
+
+	Problem load_problem(const std::string &path)
+	{
+		if (is_problem_binary(path))
+			return map_problem_binary(path);
+		return load_problem_csv(path);
+	}
+}
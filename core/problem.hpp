@@ -0,0 +1,115 @@
+#ifndef _CVX_PROBLEM_HPP_
+#define _CVX_PROBLEM_HPP_
+
+#include <memory>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "blas.hpp"
+
+// Standard form LP shared by every engine
+// min c^T * x
+// s.t. A * x = b
+//		x >= 0
+// and its dual
+// min -b^T * y
+// s.t. A^T * y + s = c
+//		s >= 0
+
+namespace cvx
+{
+	class Error : public std::runtime_error
+	{
+	public:
+		Error(const std::string &msg):
+			std::runtime_error(std::string("cvx : ").append(msg))
+		{
+		}
+	};
+
+	class SparseMatrix;
+
+	enum Layout {
+		eROW_MAJOR = 0,
+		eCOL_MAJOR = 1,
+		eCSR = 2
+	};
+
+	struct Problem
+	{
+		int32_t m = 0;
+		int32_t n = 0;
+		// A is m x n, stored as given by layout: dense in A, or sparse (eCSR)
+		// in sparse with A left null
+		Layout layout = eROW_MAJOR;
+		double_t *A = nullptr;
+		std::shared_ptr<const SparseMatrix> sparse;
+		double_t *b = nullptr;
+		double_t *c = nullptr;
+		// keeps A, b and c alive for as long as any copy of the problem exists
+		std::shared_ptr<void> storage;
+
+		bool is_sparse(void) const { return layout == eCSR; }
+		// dense A only
+		CBLAS_LAYOUT order(void) const { return layout == eROW_MAJOR ? CblasRowMajor : CblasColMajor; }
+		int32_t lda(void) const { return layout == eROW_MAJOR ? n : m; }
+	};
+
+	// Scaled KKT residuals of an iterate (x, y)
+	//	primal	||A * x - b|| / (1 + ||b||)
+	//	dual	||(A^T * y - c)_+|| / (1 + ||c||)
+	//	gap		|c^T * x - b^T * y| / (1 + |c^T * x| + |b^T * y|)
+	struct Residuals
+	{
+		double_t primal = INFINITY;
+		double_t dual = INFINITY;
+		double_t gap = INFINITY;
+	};
+
+	// An engine stops once every residual is at or below its tolerance;
+	// a negative tolerance is never met, so the engine runs its full budget.
+	struct Tolerances
+	{
+		double_t primal = 1e-4;
+		double_t dual = 1e-4;
+		double_t gap = 1e-4;
+
+		bool met(const Residuals &residuals) const
+		{
+			return residuals.primal <= primal && residuals.dual <= dual && residuals.gap <= gap;
+		}
+	};
+
+	// Iterates handed back by (and optionally into) an engine.
+	// Vectors an engine does not use are left empty.
+	struct Result
+	{
+		std::vector<double_t> x;
+		std::vector<double_t> y;
+		std::vector<double_t> s;
+		std::vector<double_t> z;
+		int32_t iterations = 0;
+		// step or penalty t the engine ended with, 0 when it has none (SSN);
+		// a resumed engine continues with it
+		double_t penalty = 0.0;
+		double_t primal = 0.0;
+		double_t dual = 0.0;
+		Residuals residuals;
+		bool converged = false;
+	};
+
+	// "primal residual: ...\tdual residual: ...\tgap: ..."
+	std::ostream &operator<<(std::ostream &out, const Residuals &residuals);
+
+	Problem allocate_problem(int32_t m, int32_t n);
+	// reads A.csv, b.csv and c.csv from directory concurrently, dims are taken
+	// from A.csv; threads <= 0 parses with every hardware thread
+	Problem load_problem_csv(const std::string &directory, int32_t threads = 0);
+	// the same problem with A stored as CSR, zeros dropped
+	Problem make_sparse(const Problem &problem);
+	// path is either a binary problem file (see binary.hpp) or a CSV directory
+	Problem load_problem(const std::string &path);
+}
+
+#endif /*!_CVX_PROBLEM_HPP_*/
@@ -0,0 +1,64 @@
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include "profile.hpp"
+#include "problem.hpp"
+
+namespace cvx {
+
+	thread_local ProfileState profileState;
+
+	static const char *phaseNames[ePHASE_COUNT] = {
+		"multiply", "alm_inner", "gram", "factor", "solve", "projection",
+		"residuals", "anderson", "norm", "trace", "checkpoint"
+	};
+
+	Profiler::Profiler(const std::string &path, const std::string &engine) :
+		_path(path), _engine(engine), _start(std::chrono::steady_clock::now())
+	{
+		profileState = ProfileState();
+	}
+
+	void Profiler::finish(int32_t iterations) const
+	{
+		if (_path.empty())
+			return;
+		const double_t seconds = std::chrono::duration<double_t>(std::chrono::steady_clock::now() - _start).count();
+
+		std::ofstream out(_path);
+		if (!out)
+			throw Error(std::string("Failed to create ").append(_path));
+		out.precision(9);
+		out << "{\n";
+		out << "\t\"engine\": \"" << _engine << "\",\n";
+#ifdef CVX_PROFILE
+		out << "\t\"profiled\": true,\n";
+#else
+		out << "\t\"profiled\": false,\n";
+#endif
+		out << "\t\"iterations\": " << iterations << ",\n";
+		out << "\t\"seconds\": " << seconds << ",\n";
+		out << "\t\"phases\": [";
+		double_t attributed = 0.0;
+		bool first = true;
+		for (int32_t p = 0; p < ePHASE_COUNT; ++p) {
+			const PhaseCounters &phase = profileState.phases[p];
+			if (phase.calls == 0)
+				continue;
+			attributed += phase.seconds;
+			//a phase too short to time reports no rates
+			double_t time = phase.seconds > 0.0 ? phase.seconds : INFINITY;
+			out << (first ? "\n" : ",\n");
+			out << "\t\t{ \"name\": \"" << phaseNames[p] << "\", \"calls\": " << phase.calls
+				<< ", \"seconds\": " << phase.seconds << ", \"flops\": " << phase.flops << ", \"bytes\": " << phase.bytes
+				<< ", \"GFLOPs\": " << phase.flops / time * 1e-9 << ", \"GBs\": " << phase.bytes / time * 1e-9 << " }";
+			first = false;
+		}
+		out << (first ? "],\n" : "\n\t],\n");
+		//engine-level vector updates and everything not wrapped in a phase
+		out << "\t\"other_seconds\": " << std::max(0.0, seconds - attributed) << "\n";
+		out << "}\n";
+		if (!out.flush())
+			throw Error(std::string("Failed to write ").append(_path));
+	}
+}
@@ -0,0 +1,129 @@
+#ifndef _CVX_PROFILE_HPP_
+#define _CVX_PROFILE_HPP_
+
+#include <chrono>
+#include <string>
+#include "blas.hpp"
+
+// Per-phase timers and flop/byte counters of one solve
+// The kernels open a CVX_PHASE scope around each call with the flops it
+// performs and the bytes it has to move at least (every operand read or
+// written once). Only the outermost scope of a thread is timed; a nested
+// scope adds its counts to the enclosing phase, so the phases never overlap
+// and the power iteration inside estimate_norm counts as eNORM. Counters are
+// thread-local: every solve of a SolverPool worker gets its own report.
+// Without CVX_PROFILE (cmake -DCVX_PROFILE=ON) the macros expand to nothing
+// and the counts are never evaluated.
+
+namespace cvx
+{
+	enum Phase {
+		// A * v and A^T * v, single and blocked
+		eMULTIPLY = 0,
+		// fused ALM inner iterations
+		eALM_INNER = 1,
+		// A * A^T and A_P * A_P^T
+		eGRAM = 2,
+		// Cholesky, LDL^T, eigendecomposition, rank-one updates
+		eFACTOR = 3,
+		// triangular and spectral solves
+		eSOLVE = 4,
+		// projections onto R+
+		ePROJECTION = 5,
+		// objectives and scaled residuals
+		eRESIDUALS = 6,
+		eANDERSON = 7,
+		// power iteration for ||A||_2
+		eNORM = 8,
+		eTRACE = 9,
+		eCHECKPOINT = 10,
+		ePHASE_COUNT = 11
+	};
+
+	struct PhaseCounters
+	{
+		uint64_t calls = 0;
+		double_t seconds = 0.0;
+		double_t flops = 0.0;
+		double_t bytes = 0.0;
+	};
+
+	struct ProfileState
+	{
+		PhaseCounters phases[ePHASE_COUNT];
+		// phase of the open outermost scope, -1 outside any
+		int32_t active = -1;
+	};
+	extern thread_local ProfileState profileState;
+
+	class ScopedPhase
+	{
+	public:
+		ScopedPhase(Phase phase, double_t flops, double_t bytes)
+		{
+			ProfileState &state = profileState;
+			_outer = state.active < 0;
+			if (_outer) {
+				state.active = phase;
+				++state.phases[phase].calls;
+				_start = std::chrono::steady_clock::now();
+			}
+			PhaseCounters &counters = state.phases[state.active];
+			counters.flops += flops;
+			counters.bytes += bytes;
+		}
+		~ScopedPhase(void)
+		{
+			if (!_outer)
+				return;
+			ProfileState &state = profileState;
+			state.phases[state.active].seconds += std::chrono::duration<double_t>(std::chrono::steady_clock::now() - _start).count();
+			state.active = -1;
+		}
+		ScopedPhase(const ScopedPhase &) = delete;
+		ScopedPhase &operator=(const ScopedPhase &) = delete;
+
+	private:
+		bool _outer;
+		std::chrono::steady_clock::time_point _start;
+	};
+
+	// counts that are known only once the work is done, added to the open phase
+	inline void count_phase(double_t flops, double_t bytes)
+	{
+		ProfileState &state = profileState;
+		if (state.active >= 0) {
+			state.phases[state.active].flops += flops;
+			state.phases[state.active].bytes += bytes;
+		}
+	}
+
+	// Report of one solve: construction clears the counters of the calling
+	// thread, finish() writes them as JSON to path (nothing when path is
+	// empty) together with the wall time since construction
+	class Profiler
+	{
+	public:
+		Profiler(const std::string &path, const std::string &engine);
+
+	public:
+		void finish(int32_t iterations) const;
+
+	private:
+		std::string _path;
+		std::string _engine;
+		std::chrono::steady_clock::time_point _start;
+	};
+}
+
+#define CVX_PHASE_NAME2(line) cvxPhase##line
+#define CVX_PHASE_NAME(line) CVX_PHASE_NAME2(line)
+#ifdef CVX_PROFILE
+#define CVX_PHASE(phase, flops, bytes) ::cvx::ScopedPhase CVX_PHASE_NAME(__LINE__)((phase), (flops), (bytes))
+#define CVX_PHASE_COUNT(flops, bytes) ::cvx::count_phase((flops), (bytes))
+#else
+#define CVX_PHASE(phase, flops, bytes) ((void)0)
+#define CVX_PHASE_COUNT(flops, bytes) ((void)0)
+#endif
+
+#endif /*!_CVX_PROFILE_HPP_*/
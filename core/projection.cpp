@@ -0,0 +1,228 @@
+#include <cstdlib>
+#include <string>
+#include "profile.hpp"
+#include "projection.hpp"
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define CVX_PROJECTION_X86
+#include <immintrin.h>
+#endif
+
+namespace cvx {
+
+	//scalar kernels, also the tails of the vector ones
+
+	static void nonneg_scalar(int32_t first, int32_t n, double_t alpha, const double_t *v, double_t *out)
+	{
+		for (int32_t i = first; i < n; ++i) {
+			double_t value = alpha * v[i];
+			out[i] = value > 0.0 ? value : 0.0;
+		}
+	}
+
+	static int32_t nonneg_active_scalar(int32_t first, int32_t n, double_t *v, int32_t *active, int32_t count)
+	{
+		for (int32_t i = first; i < n; ++i) {
+			if (v[i] < 0.0) {
+				v[i] = 0.0;
+			}
+			else {
+				active[count++] = i;
+			}
+		}
+		return count;
+	}
+
+	static void shifted_scalar(int32_t first, int32_t n, const double_t *x, const double_t *c, double_t sigma, const double_t *aty, double_t *out)
+	{
+		for (int32_t i = first; i < n; ++i) {
+			double_t value = x[i] - sigma * (c[i] - aty[i]);
+			out[i] = value > 0.0 ? value : 0.0;
+		}
+	}
+
+	static void nonneg_generic(int32_t n, double_t alpha, const double_t *v, double_t *out)
+	{
+		nonneg_scalar(0, n, alpha, v, out);
+	}
+
+	static int32_t nonneg_active_generic(int32_t n, double_t *v, int32_t *active)
+	{
+		return nonneg_active_scalar(0, n, v, active, 0);
+	}
+
+	static void shifted_generic(int32_t n, const double_t *x, const double_t *c, double_t sigma, const double_t *aty, double_t *out)
+	{
+		shifted_scalar(0, n, x, c, sigma, aty, out);
+	}
+
+#ifdef CVX_PROJECTION_X86
+	//max_pd(value, 0) returns 0 for NaN and -0, as the scalar ternary does
+
+	__attribute__((target("avx2")))
+	static void nonneg_avx2(int32_t n, double_t alpha, const double_t *v, double_t *out)
+	{
+		const __m256d scale = _mm256_set1_pd(alpha);
+		const __m256d zero = _mm256_setzero_pd();
+		int32_t i = 0;
+		for (; i + 4 <= n; i += 4) {
+			_mm256_storeu_pd(out + i, _mm256_max_pd(_mm256_mul_pd(scale, _mm256_loadu_pd(v + i)), zero));
+		}
+		nonneg_scalar(i, n, alpha, v, out);
+	}
+
+	//lanes kept for each 4-bit movemask, packed to the front
+	alignas(16) static const int32_t packedLanes[16][4] = {
+		{ 0, 0, 0, 0 }, { 0, 0, 0, 0 }, { 1, 0, 0, 0 }, { 0, 1, 0, 0 },
+		{ 2, 0, 0, 0 }, { 0, 2, 0, 0 }, { 1, 2, 0, 0 }, { 0, 1, 2, 0 },
+		{ 3, 0, 0, 0 }, { 0, 3, 0, 0 }, { 1, 3, 0, 0 }, { 0, 1, 3, 0 },
+		{ 2, 3, 0, 0 }, { 0, 2, 3, 0 }, { 1, 2, 3, 0 }, { 0, 1, 2, 3 }
+	};
+
+	__attribute__((target("avx2,popcnt")))
+	static int32_t nonneg_active_avx2(int32_t n, double_t *v, int32_t *active)
+	{
+		const __m256d zero = _mm256_setzero_pd();
+		int32_t count = 0;
+		int32_t i = 0;
+		for (; i + 4 <= n; i += 4) {
+			__m256d value = _mm256_loadu_pd(v + i);
+			__m256d negative = _mm256_cmp_pd(value, zero, _CMP_LT_OQ);
+			_mm256_storeu_pd(v + i, _mm256_andnot_pd(negative, value));
+			int32_t kept = ~_mm256_movemask_pd(negative) & 0xF;
+			//always stores four indices, count <= i keeps them inside active
+			__m128i lanes = _mm_load_si128(reinterpret_cast<const __m128i *>(packedLanes[kept]));
+			_mm_storeu_si128(reinterpret_cast<__m128i *>(active + count), _mm_add_epi32(lanes, _mm_set1_epi32(i)));
+			count += _mm_popcnt_u32(kept);
+		}
+		return nonneg_active_scalar(i, n, v, active, count);
+	}
+
+	__attribute__((target("avx2")))
+	static void shifted_avx2(int32_t n, const double_t *x, const double_t *c, double_t sigma, const double_t *aty, double_t *out)
+	{
+		const __m256d scale = _mm256_set1_pd(sigma);
+		const __m256d zero = _mm256_setzero_pd();
+		int32_t i = 0;
+		for (; i + 4 <= n; i += 4) {
+			__m256d residual = _mm256_sub_pd(_mm256_loadu_pd(c + i), _mm256_loadu_pd(aty + i));
+			__m256d value = _mm256_sub_pd(_mm256_loadu_pd(x + i), _mm256_mul_pd(scale, residual));
+			_mm256_storeu_pd(out + i, _mm256_max_pd(value, zero));
+		}
+		shifted_scalar(i, n, x, c, sigma, aty, out);
+	}
+
+	//the AVX-512 max is the zero-masked form with every lane selected, the
+	//same instruction without the undefined pass-through operand of
+	//_mm512_max_pd that GCC reports as maybe-uninitialized
+	const static __mmask8 allLanes = 0xFF;
+
+	__attribute__((target("avx512f")))
+	static void nonneg_avx512(int32_t n, double_t alpha, const double_t *v, double_t *out)
+	{
+		const __m512d scale = _mm512_set1_pd(alpha);
+		const __m512d zero = _mm512_setzero_pd();
+		int32_t i = 0;
+		for (; i + 8 <= n; i += 8) {
+			_mm512_storeu_pd(out + i, _mm512_maskz_max_pd(allLanes, _mm512_mul_pd(scale, _mm512_loadu_pd(v + i)), zero));
+		}
+		nonneg_scalar(i, n, alpha, v, out);
+	}
+
+	__attribute__((target("avx512f,popcnt")))
+	static int32_t nonneg_active_avx512(int32_t n, double_t *v, int32_t *active)
+	{
+		const __m512d zero = _mm512_setzero_pd();
+		const __m512i lanes = _mm512_set_epi32(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0);
+		int32_t count = 0;
+		int32_t i = 0;
+		for (; i + 8 <= n; i += 8) {
+			__m512d value = _mm512_loadu_pd(v + i);
+			__mmask8 negative = _mm512_cmp_pd_mask(value, zero, _CMP_LT_OQ);
+			_mm512_mask_storeu_pd(v + i, negative, zero);
+			//the upper eight lanes are never selected
+			__mmask16 kept = (__mmask16)(~negative & 0xFF);
+			_mm512_mask_compressstoreu_epi32(active + count, kept, _mm512_add_epi32(lanes, _mm512_set1_epi32(i)));
+			count += _mm_popcnt_u32(kept);
+		}
+		return nonneg_active_scalar(i, n, v, active, count);
+	}
+
+	__attribute__((target("avx512f")))
+	static void shifted_avx512(int32_t n, const double_t *x, const double_t *c, double_t sigma, const double_t *aty, double_t *out)
+	{
+		const __m512d scale = _mm512_set1_pd(sigma);
+		const __m512d zero = _mm512_setzero_pd();
+		int32_t i = 0;
+		for (; i + 8 <= n; i += 8) {
+			__m512d residual = _mm512_sub_pd(_mm512_loadu_pd(c + i), _mm512_loadu_pd(aty + i));
+			__m512d value = _mm512_sub_pd(_mm512_loadu_pd(x + i), _mm512_mul_pd(scale, residual));
+			_mm512_storeu_pd(out + i, _mm512_maskz_max_pd(allLanes, value, zero));
+		}
+		shifted_scalar(i, n, x, c, sigma, aty, out);
+	}
+#endif
+
+	bool projection_kernels(const std::string &isa, ProjectionKernels &out)
+	{
+#ifdef CVX_PROJECTION_X86
+		__builtin_cpu_init();
+		if (isa == "avx512" && __builtin_cpu_supports("avx512f")) {
+			out = { "avx512", nonneg_avx512, nonneg_active_avx512, shifted_avx512 };
+			return true;
+		}
+		if (isa == "avx2" && __builtin_cpu_supports("avx2")) {
+			out = { "avx2", nonneg_avx2, nonneg_active_avx2, shifted_avx2 };
+			return true;
+		}
+#endif
+		if (isa == "scalar") {
+			out = { "scalar", nonneg_generic, nonneg_active_generic, shifted_generic };
+			return true;
+		}
+		return false;
+	}
+
+	static ProjectionKernels select_kernels(void)
+	{
+		//CVX_SIMD=scalar|avx2 caps the choice, for debugging and benchmarks
+		const char *cap = std::getenv("CVX_SIMD");
+		std::string limit = cap ? cap : "";
+		ProjectionKernels selected;
+		if (limit.empty() && projection_kernels("avx512", selected))
+			return selected;
+		if ((limit.empty() || limit == "avx2") && projection_kernels("avx2", selected))
+			return selected;
+		projection_kernels("scalar", selected);
+		return selected;
+	}
+
+	static const ProjectionKernels &kernels(void)
+	{
+		static const ProjectionKernels selected = select_kernels();
+		return selected;
+	}
+
+	void project_nonneg(int32_t n, double_t alpha, const double_t *v, double_t *out)
+	{
+		CVX_PHASE(ePROJECTION, 2.0 * n, 16.0 * n);
+		kernels().nonneg(n, alpha, v, out);
+	}
+
+	int32_t project_nonneg_active(int32_t n, double_t *v, int32_t *active)
+	{
+		CVX_PHASE(ePROJECTION, 1.0 * n, 20.0 * n);
+		return kernels().nonnegActive(n, v, active);
+	}
+
+	void project_shifted(int32_t n, const double_t *x, const double_t *c, double_t sigma, const double_t *aty, double_t *out)
+	{
+		CVX_PHASE(ePROJECTION, 4.0 * n, 32.0 * n);
+		kernels().shifted(n, x, c, sigma, aty, out);
+	}
+
+	const char *projection_isa(void)
+	{
+		return kernels().isa;
+	}
+}
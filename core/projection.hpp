@@ -0,0 +1,37 @@
+#ifndef _CVX_PROJECTION_HPP_
+#define _CVX_PROJECTION_HPP_
+
+#include <string>
+#include "blas.hpp"
+
+// Projections onto R+^n. Each call runs the widest kernel the CPU supports
+// (AVX-512, AVX2, or scalar), picked once at the first call.
+
+namespace cvx
+{
+	// out = P_+(alpha * v), out may alias v
+	void project_nonneg(int32_t n, double_t alpha, const double_t *v, double_t *out);
+	// v = P_+(v) in place, the indices kept positive are written to active
+	// (n entries) in ascending order and their count is returned
+	int32_t project_nonneg_active(int32_t n, double_t *v, int32_t *active);
+	// out = P_+(x - sigma * (c - aty)), out may alias aty
+	void project_shifted(int32_t n, const double_t *x, const double_t *c, double_t sigma, const double_t *aty, double_t *out);
+
+	// "avx512", "avx2" or "scalar"
+	const char *projection_isa(void);
+
+	// The kernels behind the calls above for one ISA
+	struct ProjectionKernels
+	{
+		const char *isa;
+		void (*nonneg)(int32_t, double_t, const double_t *, double_t *);
+		int32_t (*nonnegActive)(int32_t, double_t *, int32_t *);
+		void (*shifted)(int32_t, const double_t *, const double_t *, double_t, const double_t *, double_t *);
+	};
+
+	// the kernels of isa ("avx512", "avx2" or "scalar"), whatever CVX_SIMD
+	// says; false when the CPU lacks the ISA. For comparing the variants
+	bool projection_kernels(const std::string &isa, ProjectionKernels &out);
+}
+
+#endif /*!_CVX_PROJECTION_HPP_*/
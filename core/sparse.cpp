@@ -0,0 +1,221 @@
+#include <climits>
+#include <vector>
+#include "sparse.hpp"
+#include "problem.hpp"
+
+namespace cvx {
+
+	// expected number of products per operation, tells MKL how much
+	// inspection time is worth spending
+	const static int32_t expectedCalls = 1000;
+
+	SparseMatrix::SparseMatrix(int32_t rows, int32_t cols, const int64_t *rowPtr, const int32_t *colIdx, const double_t *values, std::shared_ptr<void> storage)
+		: _rows(rows), _cols(cols), _rowPtr(rowPtr), _colIdx(colIdx), _values(values), _storage(storage)
+	{
+		const int64_t nnz = rowPtr[rows];
+		for (int64_t p = 0; p < nnz; ++p) {
+			if (colIdx[p] < 0 || colIdx[p] >= cols)
+				throw Error("sparse column index out of range");
+		}
+
+#ifdef CVX_USE_MKL
+		_descr.type = SPARSE_MATRIX_TYPE_GENERAL;
+		//LP64 MKL takes 32-bit row pointers, ILP64 MKL 64-bit column indices
+		MKL_INT *mklRowPtr = (MKL_INT*)rowPtr;
+		MKL_INT *mklColIdx = (MKL_INT*)colIdx;
+		if (sizeof(MKL_INT) != sizeof(int64_t)) {
+			if (nnz > INT32_MAX)
+				throw Error("more than 2^31 - 1 nonzeros need the ILP64 MKL interface (CVX_MKL_ILP64)");
+			_mklRowPtr.assign(rowPtr, rowPtr + rows + 1);
+			mklRowPtr = _mklRowPtr.data();
+		}
+		if (sizeof(MKL_INT) != sizeof(int32_t)) {
+			_mklColIdx.assign(colIdx, colIdx + nnz);
+			mklColIdx = _mklColIdx.data();
+		}
+		sparse_status_t status = mkl_sparse_d_create_csr(&_handle, SPARSE_INDEX_BASE_ZERO, rows, cols,
+			mklRowPtr, mklRowPtr + 1, mklColIdx, (double*)values);
+		if (status != SPARSE_STATUS_SUCCESS)
+			throw Error("mkl_sparse_d_create_csr failed");
+		mkl_sparse_set_mv_hint(_handle, SPARSE_OPERATION_NON_TRANSPOSE, _descr, expectedCalls);
+		mkl_sparse_set_mv_hint(_handle, SPARSE_OPERATION_TRANSPOSE, _descr, expectedCalls);
+		mkl_sparse_set_memory_hint(_handle, SPARSE_MEMORY_AGGRESSIVE);
+		mkl_sparse_optimize(_handle);
+#endif
+	}
+
+	SparseMatrix::~SparseMatrix(void)
+	{
+#ifdef CVX_USE_MKL
+		mkl_sparse_destroy(_handle);
+#endif
+	}
+
+	void SparseMatrix::build_csc(void) const
+	{
+		std::call_once(_cscOnce, [this]() {
+			//CSC by counting sort over the columns
+			const int64_t nnz = _rowPtr[_rows];
+			_colPtr.assign(_cols + 1, 0);
+			_rowIdx.resize(nnz);
+			_colValues.resize(nnz);
+			for (int64_t p = 0; p < nnz; ++p) {
+				++_colPtr[_colIdx[p] + 1];
+			}
+			for (int32_t j = 0; j < _cols; ++j) {
+				_colPtr[j + 1] += _colPtr[j];
+			}
+			std::vector<int64_t> next(_colPtr.begin(), _colPtr.end() - 1);
+			for (int32_t i = 0; i < _rows; ++i) {
+				for (int64_t p = _rowPtr[i]; p < _rowPtr[i + 1]; ++p) {
+					int64_t q = next[_colIdx[p]]++;
+					_rowIdx[q] = i;
+					_colValues[q] = _values[p];
+				}
+			}
+		});
+	}
+
+	// Arrays of from_dense, released with the matrix
+	struct SparseStorage
+	{
+		std::vector<int64_t> rowPtr;
+		std::vector<int32_t> colIdx;
+		std::vector<double_t> values;
+	};
+
+	std::shared_ptr<SparseMatrix> SparseMatrix::from_dense(int32_t rows, int32_t cols, const double_t *A, bool rowMajor, int32_t lda)
+	{
+		std::shared_ptr<SparseStorage> storage = std::make_shared<SparseStorage>();
+		storage->rowPtr.push_back(0);
+		for (int32_t i = 0; i < rows; ++i) {
+			for (int32_t j = 0; j < cols; ++j) {
+				double_t value = rowMajor ? A[(size_t)i*lda + j] : A[(size_t)j*lda + i];
+				if (value != 0.0) {
+					storage->colIdx.push_back(j);
+					storage->values.push_back(value);
+				}
+			}
+			storage->rowPtr.push_back((int64_t)storage->colIdx.size());
+		}
+		return std::make_shared<SparseMatrix>(rows, cols, storage->rowPtr.data(), storage->colIdx.data(), storage->values.data(), storage);
+	}
+
+	std::shared_ptr<SparseMatrix> SparseMatrix::from_csr(int32_t rows, int32_t cols, std::vector<int64_t> rowPtr, std::vector<int32_t> colIdx, std::vector<double_t> values)
+	{
+		if (rowPtr.size() != (size_t)rows + 1 || (size_t)rowPtr[rows] != colIdx.size() || colIdx.size() != values.size())
+			throw Error("inconsistent CSR arrays");
+		std::shared_ptr<SparseStorage> storage = std::make_shared<SparseStorage>();
+		storage->rowPtr = std::move(rowPtr);
+		storage->colIdx = std::move(colIdx);
+		storage->values = std::move(values);
+		return std::make_shared<SparseMatrix>(rows, cols, storage->rowPtr.data(), storage->colIdx.data(), storage->values.data(), storage);
+	}
+
+	void SparseMatrix::multiply(double_t alpha, const double_t *v, double_t beta, double_t *out) const
+	{
+#ifdef CVX_USE_MKL
+		mkl_sparse_d_mv(SPARSE_OPERATION_NON_TRANSPOSE, alpha, _handle, _descr, v, beta, out);
+#else
+		for (int32_t i = 0; i < _rows; ++i) {
+			double_t sum = 0.0;
+			for (int64_t p = _rowPtr[i]; p < _rowPtr[i + 1]; ++p) {
+				sum += _values[p] * v[_colIdx[p]];
+			}
+			out[i] = beta == 0.0 ? alpha * sum : alpha * sum + beta * out[i];
+		}
+#endif
+	}
+
+	void SparseMatrix::multiply_transpose(double_t alpha, const double_t *v, double_t beta, double_t *out) const
+	{
+#ifdef CVX_USE_MKL
+		mkl_sparse_d_mv(SPARSE_OPERATION_TRANSPOSE, alpha, _handle, _descr, v, beta, out);
+#else
+		build_csc();
+		for (int32_t j = 0; j < _cols; ++j) {
+			double_t sum = 0.0;
+			for (int64_t p = _colPtr[j]; p < _colPtr[j + 1]; ++p) {
+				sum += _colValues[p] * v[_rowIdx[p]];
+			}
+			out[j] = beta == 0.0 ? alpha * sum : alpha * sum + beta * out[j];
+		}
+#endif
+	}
+
+	// one gather row of a block product: out_k[i] = alpha * (row . V_k) + beta * out_k[i]
+	static void gather_rows(int32_t rows, const int64_t *ptr, const int32_t *idx, const double_t *values, int32_t count, double_t alpha, const double_t *V, int32_t ldv, double_t beta, double_t *out, int32_t ldo)
+	{
+		for (int32_t i = 0; i < rows; ++i) {
+			//the nonzeros of row i stay in L1 across the count vectors
+			for (int32_t k = 0; k < count; ++k) {
+				const double_t *v = V + (size_t)k * ldv;
+				double_t sum = 0.0;
+				for (int64_t p = ptr[i]; p < ptr[i + 1]; ++p) {
+					sum += values[p] * v[idx[p]];
+				}
+				double_t &o = out[(size_t)k * ldo + i];
+				o = beta == 0.0 ? alpha * sum : alpha * sum + beta * o;
+			}
+		}
+	}
+
+	void SparseMatrix::multiply_block(int32_t count, double_t alpha, const double_t *V, int32_t ldv, double_t beta, double_t *out, int32_t ldo) const
+	{
+#ifdef CVX_USE_MKL
+		mkl_sparse_d_mm(SPARSE_OPERATION_NON_TRANSPOSE, alpha, _handle, _descr, SPARSE_LAYOUT_COLUMN_MAJOR, V, count, ldv, beta, out, ldo);
+#else
+		gather_rows(_rows, _rowPtr, _colIdx, _values, count, alpha, V, ldv, beta, out, ldo);
+#endif
+	}
+
+	void SparseMatrix::multiply_transpose_block(int32_t count, double_t alpha, const double_t *V, int32_t ldv, double_t beta, double_t *out, int32_t ldo) const
+	{
+#ifdef CVX_USE_MKL
+		mkl_sparse_d_mm(SPARSE_OPERATION_TRANSPOSE, alpha, _handle, _descr, SPARSE_LAYOUT_COLUMN_MAJOR, V, count, ldv, beta, out, ldo);
+#else
+		//the rows of A^T are the CSC columns
+		build_csc();
+		gather_rows(_cols, _colPtr.data(), _rowIdx.data(), _colValues.data(), count, alpha, V, ldv, beta, out, ldo);
+#endif
+	}
+
+	void SparseMatrix::column(int32_t j, double_t alpha, double_t *out) const
+	{
+		build_csc();
+		for (int32_t i = 0; i < _rows; ++i) {
+			out[i] = 0.0;
+		}
+		for (int64_t p = _colPtr[j]; p < _colPtr[j + 1]; ++p) {
+			out[_rowIdx[p]] = alpha * _colValues[p];
+		}
+	}
+
+	void SparseMatrix::gram(const int32_t *columns, int32_t count, double_t alpha, double_t beta, double_t *out) const
+	{
+		build_csc();
+		const size_t size = (size_t)_rows * _rows;
+		for (size_t i = 0; i < size; ++i) {
+			out[i] = beta == 0.0 ? 0.0 : beta * out[i];
+		}
+
+		//sum of alpha * a_j * a_j^T over the selected columns, upper triangle only
+		for (int32_t k = 0; k < count; ++k) {
+			int32_t j = columns == nullptr ? k : columns[k];
+			for (int64_t p = _colPtr[j]; p < _colPtr[j + 1]; ++p) {
+				double_t scaled = alpha * _colValues[p];
+				double_t *row = out + (size_t)_rowIdx[p] * _rows;
+				for (int64_t q = p; q < _colPtr[j + 1]; ++q) {
+					row[_rowIdx[q]] += scaled * _colValues[q];
+				}
+			}
+		}
+
+		//mirror to the lower triangle
+		for (int32_t i = 0; i < _rows; ++i) {
+			for (int32_t k = 0; k < i; ++k) {
+				out[(size_t)i*_rows + k] = out[(size_t)k*_rows + i];
+			}
+		}
+	}
+}
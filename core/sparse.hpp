@@ -0,0 +1,86 @@
+#ifndef _CVX_SPARSE_HPP_
+#define _CVX_SPARSE_HPP_
+
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "blas.hpp"
+
+namespace cvx
+{
+	// Sparse A in CSR, with a CSC copy so that A^T * v and the column-wise
+	// products A_J * A_J^T are gathers as well.
+	// With CVX_USE_MKL the products run through an inspector-executor handle
+	// optimized for both operations; otherwise the loops below are used.
+	// The CSC copy doubles the memory of A, so it is built on the first call
+	// that reads it (the OpenBLAS transposed products, gram, column and the
+	// col_* accessors) and never for an MKL solve that only multiplies.
+	// Row and column pointers are 64-bit so nnz may exceed 2^31, indices
+	// within a row or column stay int32.
+	class SparseMatrix
+	{
+	public:
+		// rowPtr (rows + 1), colIdx and values (rowPtr[rows]) must stay valid
+		// for the lifetime of storage
+		SparseMatrix(int32_t rows, int32_t cols, const int64_t *rowPtr, const int32_t *colIdx, const double_t *values, std::shared_ptr<void> storage);
+		~SparseMatrix(void);
+		SparseMatrix(const SparseMatrix &) = delete;
+		SparseMatrix &operator=(const SparseMatrix &) = delete;
+
+		// CSR of the nonzeros of a dense matrix, stored as given by rowMajor/lda
+		static std::shared_ptr<SparseMatrix> from_dense(int32_t rows, int32_t cols, const double_t *A, bool rowMajor, int32_t lda);
+		// takes over CSR arrays built elsewhere
+		static std::shared_ptr<SparseMatrix> from_csr(int32_t rows, int32_t cols, std::vector<int64_t> rowPtr, std::vector<int32_t> colIdx, std::vector<double_t> values);
+
+	public:
+		int32_t rows(void) const { return _rows; }
+		int32_t cols(void) const { return _cols; }
+		int64_t nnz(void) const { return _rowPtr[_rows]; }
+		const int64_t *row_ptr(void) const { return _rowPtr; }
+		const int32_t *col_idx(void) const { return _colIdx; }
+		const double_t *values(void) const { return _values; }
+		const int64_t *col_ptr(void) const { build_csc(); return _colPtr.data(); }
+		const int32_t *row_idx(void) const { build_csc(); return _rowIdx.data(); }
+		const double_t *col_values(void) const { build_csc(); return _colValues.data(); }
+
+		// out = alpha * A * v + beta * out
+		void multiply(double_t alpha, const double_t *v, double_t beta, double_t *out) const;
+		// out = alpha * A^T * v + beta * out
+		void multiply_transpose(double_t alpha, const double_t *v, double_t beta, double_t *out) const;
+		// the products above for count vectors at once: V and out are
+		// column-major with leading dimensions ldv and ldo, A is read once
+		void multiply_block(int32_t count, double_t alpha, const double_t *V, int32_t ldv, double_t beta, double_t *out, int32_t ldo) const;
+		void multiply_transpose_block(int32_t count, double_t alpha, const double_t *V, int32_t ldv, double_t beta, double_t *out, int32_t ldo) const;
+		// out = alpha * a_j, the dense column j
+		void column(int32_t j, double_t alpha, double_t *out) const;
+		// out = alpha * A_J * A_J^T + beta * out, out is rows x rows and filled
+		// completely; columns == nullptr takes every column
+		void gram(const int32_t *columns, int32_t count, double_t alpha, double_t beta, double_t *out) const;
+
+	private:
+		// fills the CSC copy once, safe from concurrent solves
+		void build_csc(void) const;
+
+	private:
+		int32_t _rows;
+		int32_t _cols;
+		const int64_t *_rowPtr;
+		const int32_t *_colIdx;
+		const double_t *_values;
+		std::shared_ptr<void> _storage;
+		// CSC copy, empty until build_csc()
+		mutable std::once_flag _cscOnce;
+		mutable std::vector<int64_t> _colPtr;
+		mutable std::vector<int32_t> _rowIdx;
+		mutable std::vector<double_t> _colValues;
+#ifdef CVX_USE_MKL
+		sparse_matrix_t _handle;
+		matrix_descr _descr;
+		// MKL_INT copies of whichever of rowPtr and colIdx differ in width
+		std::vector<MKL_INT> _mklRowPtr;
+		std::vector<MKL_INT> _mklColIdx;
+#endif
+	};
+}
+
+#endif /*!_CVX_SPARSE_HPP_*/
@@ -0,0 +1,142 @@
+#include <algorithm>
+#include <cmath>
+#include "ssn.hpp"
+#include "kernels.hpp"
+#include "profile.hpp"
+#include "linear_solver.hpp"
+#include "workspace.hpp"
+
+namespace cvx {
+
+	Result solve_ssn(const Problem &problem, const SsnOptions &options, const Result *start)
+	{
+		Profiler profiler(options.profile, "ssn");
+		const int32_t m = problem.m;
+		const int32_t n = problem.n;
+		const double_t k = options.k;
+		const double_t sigma = options.sigma;
+
+		Workspace workspace;
+		double_t *x = workspace.vector(n);
+		double_t *y = workspace.vector(m);
+		double_t *projection = workspace.vector(n);
+		double_t *aty = workspace.vector(n);
+		double_t *gradient = workspace.vector(m);
+		double_t *newton = workspace.vector(m);
+		double_t *jacobian = workspace.vector((size_t)m * m);
+		double_t *column = workspace.vector(m);
+		int32_t *active = workspace.indices(n);
+		int32_t *previous = workspace.indices(n);
+		int32_t *changed = workspace.indices(n + 1);
+		int32_t previousCount = 0;
+		//A_P for dense A, grows with the largest active set seen
+		std::vector<double_t> gathered;
+		SpdSolver solver;
+		//mu the current factor was built with, iterations since it was built
+		double_t factorMu = 0.0;
+		int32_t updates = 0;
+		const int32_t updateRank = options.updateRank == 0 ? std::max(1, m / 4) : options.updateRank;
+
+		initial_iterate(start ? &start->x : nullptr, x, n);
+		initial_iterate(start ? &start->y : nullptr, y, m);
+
+		Trace trace(options.trace);
+		Checkpointer checkpointer(options.checkpoint, "ssn", problem);
+		//the iterate handed to the checkpoint writer
+		auto snapshot = [&](Result state) {
+			state.x.assign(x, x + n);
+			state.y.assign(y, y + m);
+			return state;
+		};
+
+		Result result;
+		const int32_t first = start ? start->iterations : 0;
+		result.iterations = first;
+		for (int32_t outer = first; ; ++outer) {
+			//aty = A^T * y
+			multiply_At(problem, 1.0, y, 0.0, aty);
+			//residuals of the previous iterate, gradient = A * x - b
+			if (outer > first) {
+				result.residuals.primal = primal_infeasibility(problem, gradient);
+				result.residuals.dual = dual_infeasibility(problem, aty);
+				result.residuals.gap = relative_gap(result.primal, result.dual);
+				if (options.tolerances.met(result.residuals)) {
+					result.converged = true;
+					break;
+				}
+			}
+			if (outer >= options.outerCount)
+				break;
+
+			//update of y
+
+			//projection = x - sigma * (c - A^T * y)
+			shifted_dual_residual(problem, x, aty, sigma, projection);
+			//project to R+
+			int32_t count = project_nonneg_active(n, projection, active);
+			//gradient = A * projection
+			multiply_A(problem, 1.0, projection, 0.0, gradient);
+			//gradient = -b + gradient
+			cblas_daxpby(m, -1.0, problem.b, 1, 1.0, gradient, 1);
+			//mu = k * ||fk||_2
+			double_t mu = k * cblas_dnrm2(m, gradient, 1);
+
+			//carry the previous factor over when P and mu moved little
+			int32_t changes = updateRank + 1;
+			if (solver.method() == SpdSolver::eCHOLESKY && updates < options.refactorInterval && std::abs(mu - factorMu) <= options.muTolerance * factorMu)
+				changes = active_changes(previous, previousCount, active, count, updateRank, changed);
+			bool updated = changes <= updateRank;
+			//updates (entering P) before downdates (leaving P)
+			for (int32_t pass = 0; pass < 2 && updated; ++pass) {
+				for (int32_t i = 0; i < changes && updated; ++i) {
+					bool entering = changed[i] >= 0;
+					if (entering != (pass == 0))
+						continue;
+					column_of_A(problem, entering ? changed[i] : ~changed[i], std::sqrt(sigma), column);
+					updated = solver.rank_one(column, entering ? 1.0 : -1.0);
+				}
+			}
+
+			if (updated) {
+				++updates;
+			}
+			else {
+				//jacobian = sigma * A_P * A_P^T, P = active
+				gram_columns(problem, active, count, sigma, 0.0, jacobian, gathered);
+				//jacobian = mu * I + jacobian
+				for (int32_t i = 0; i < m; ++i) {
+					jacobian[(size_t)i*m + i] += mu;
+				}
+				solver.factor(jacobian, m);
+				factorMu = mu;
+				updates = 0;
+			}
+			std::copy(active, active + count, previous);
+			previousCount = count;
+
+			//newton = -jacobian^-1 * gradient
+			cblas_daxpby(m, -1.0, gradient, 1, 0.0, newton, 1);
+			solver.solve(newton);
+			//y = gradient + y;
+			cblas_daxpby(m, 1.0, newton, 1, 1.0, y, 1);
+
+			//update of x
+			//x = projection
+			cblas_daxpby(n, 1.0, projection, 1, 0.0, x, 1);
+
+			result.primal = primal_objective(problem, x);
+			result.dual = dual_objective(problem, y);
+			result.iterations = outer + 1;
+			//the residuals of this iterate are checked at the top of the next one
+			trace.record(result.iterations, result.primal, result.dual);
+			if (checkpointer.due(result.iterations))
+				checkpointer.save(snapshot(result));
+		}
+		trace.finish(result);
+
+		result = snapshot(std::move(result));
+		checkpointer.finish(result);
+		profiler.finish(result.iterations);
+		return result;
+	}
+}
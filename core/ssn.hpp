@@ -0,0 +1,58 @@
+#ifndef _CVX_SSN_HPP_
+#define _CVX_SSN_HPP_
+
+#include "checkpoint.hpp"
+#include "trace.hpp"
+
+// semi-smooth Newton method for minimizing augmented Lagrangian function
+// min -b^y
+// s.t. A^T * y + s = c
+//		s >= 0
+// L = -b^T * y + 1/(2*sigma)(||P_+(x-\sigma(c-A^T*y))||_2^2-||x||_s^2)
+// \nabla{L} = -b+AP_+(x-\sigma(c-A^T*y)) = 0
+// J = A * D * A^T = A_P * A_P^T
+// D(ij) = 0 (x-\sigma(c-A^T*y) < 0)
+// D(ij) = 1 (x-\sigma(c-A^T*y) >= 0)
+// D is never formed: the active set P = {i : D(ii) = 1} is tracked instead,
+// the active columns of A are gathered and J is built with a rank-|P| update
+// (J + \mu * I) * d = -fk
+// When P changes by only a few indices and mu stays close to the value the
+// current Cholesky factor was built with, the factor is carried over with
+// rank-one updates (indices entering P) and downdates (indices leaving P),
+// O(m^2) each, instead of rebuilding and refactoring J in O(m^2|P| + m^3)
+// mu = k * fk
+// y_+ = y + d
+// x_+ = P_+(x-\sigma(c-A^T*y_+))
+// A^T*y_+ is needed for x_+ anyway and \nabla{L} = A*x_+ - b, so the residuals
+// of (x_+, y_+) come for free at the start of the next iteration
+
+namespace cvx
+{
+	struct SsnOptions
+	{
+		double_t k = 10;
+		double_t sigma = 0.01;
+		int32_t outerCount = 3000;
+		// largest change of the active set handled by rank-one updates of the
+		// previous factor, 0 picks m / 4, negative always refactors
+		int32_t updateRank = 0;
+		// the previous factor is kept while |mu - mu_factor| <= muTolerance * mu_factor
+		double_t muTolerance = 0.5;
+		// refactor after this many updated iterations to flush rounding drift
+		int32_t refactorInterval = 50;
+		// checked before every iteration
+		Tolerances tolerances;
+		// periodic snapshots of the state for --resume, see checkpoint.hpp
+		CheckpointOptions checkpoint;
+		// printed lines and the in-memory iteration trace, see trace.hpp
+		TraceOptions trace;
+		// JSON report of the per-phase timers, see profile.hpp
+		std::string profile;
+	};
+
+	// start may carry x (n) and y (m), missing vectors start from zero; a
+	// resumed start also continues its iteration count
+	Result solve_ssn(const Problem &problem, const SsnOptions &options, const Result *start = nullptr);
+}
+
+#endif /*!_CVX_SSN_HPP_*/
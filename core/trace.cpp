@@ -0,0 +1,118 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include "profile.hpp"
+#include "trace.hpp"
+
+namespace cvx {
+
+	static const char traceMagic[8] = { 'C', 'V', 'X', 'T', 'R', 'A', 'C', 'E' };
+
+	Trace::Trace(const TraceOptions &options) :
+		_options(options), _start(std::chrono::steady_clock::now()), _next(0), _dropped(0), _printed(0)
+	{
+		_options.capacity = std::max(_options.capacity, 1);
+	}
+
+	bool Trace::sampled(int32_t iteration) const
+	{
+		return (_options.sampleInterval > 0 && iteration % _options.sampleInterval == 0)
+			|| (_options.printInterval > 0 && iteration % _options.printInterval == 0);
+	}
+
+	void Trace::record(int32_t iteration, double_t primal, double_t dual, const Residuals &residuals)
+	{
+		CVX_PHASE(eTRACE, 0.0, sizeof(TraceRecord));
+		TraceRecord record;
+		record.seconds = std::chrono::duration<double_t>(std::chrono::steady_clock::now() - _start).count();
+		record.primal = primal;
+		record.dual = dual;
+		record.primalResidual = residuals.primal;
+		record.dualResidual = residuals.dual;
+		record.gap = residuals.gap;
+		record.iteration = iteration;
+		record.reserved = 0;
+
+		if (_records.size() < (size_t)_options.capacity) {
+			_records.push_back(record);
+		}
+		else {
+			_records[_next] = record;
+			_next = (_next + 1) % _records.size();
+			++_dropped;
+		}
+
+		if (_options.printInterval > 0 && iteration % _options.printInterval == 0) {
+			print(record);
+			_printed = iteration;
+		}
+	}
+
+	void Trace::print(const TraceRecord &record) const
+	{
+		std::cout << "count: " << record.iteration << "\tprimal: " << record.primal << "\tdual: " << record.dual;
+		if (std::isfinite(record.primalResidual))
+			std::cout << "\tprimal residual: " << record.primalResidual << "\tdual residual: " << record.dualResidual << "\tgap: " << record.gap;
+		std::cout << '\n';
+	}
+
+	void Trace::finish(const Result &result)
+	{
+		CVX_PHASE(eTRACE, 0.0, sizeof(TraceRecord) * size());
+		if (!_records.empty()) {
+			const TraceRecord &last = (*this)[size() - 1];
+			if (last.iteration != _printed)
+				print(last);
+		}
+		if (result.converged)
+			std::cout << "converged\t" << result.residuals << '\n';
+		else
+			std::cout << "not converged after " << result.iterations << " iterations\t" << result.residuals << '\n';
+		std::cout.flush();
+		if (!_options.path.empty())
+			dump();
+	}
+
+	void Trace::dump(void) const
+	{
+		const std::string &path = _options.path;
+		bool csv = path.size() >= 4 && path.compare(path.size() - 4, 4, ".csv") == 0;
+		if (csv) {
+			std::ofstream out(path);
+			if (!out)
+				throw Error(std::string("Failed to create ").append(path));
+			out.precision(17);
+			out << "iteration,seconds,primal,dual,primal_residual,dual_residual,gap\n";
+			for (size_t i = 0; i < size(); ++i) {
+				const TraceRecord &record = (*this)[i];
+				out << record.iteration << ',' << record.seconds << ',' << record.primal << ',' << record.dual << ','
+					<< record.primalResidual << ',' << record.dualResidual << ',' << record.gap << '\n';
+			}
+			if (!out.flush())
+				throw Error(std::string("Failed to write ").append(path));
+			return;
+		}
+
+		TraceHeader header;
+		memset(&header, 0, sizeof(header));
+		memcpy(header.magic, traceMagic, sizeof(traceMagic));
+		header.version = traceVersion;
+		header.recordSize = sizeof(TraceRecord);
+		header.count = size();
+		header.dropped = _dropped;
+
+		FILE *file = fopen(path.c_str(), "wb");
+		if (file == nullptr)
+			throw Error(std::string("Failed to create ").append(path));
+		bool written = fwrite(&header, sizeof(header), 1, file) == 1;
+		//the ring in two pieces, oldest first
+		size_t tail = _records.size() - _next;
+		written = written && fwrite(_records.data() + _next, sizeof(TraceRecord), tail, file) == tail;
+		written = written && fwrite(_records.data(), sizeof(TraceRecord), _next, file) == _next;
+		if (fclose(file) != 0 || !written)
+			throw Error(std::string("Failed to write ").append(path));
+	}
+}
@@ -0,0 +1,93 @@
+#ifndef _CVX_TRACE_HPP_
+#define _CVX_TRACE_HPP_
+
+#include <chrono>
+#include "problem.hpp"
+
+// Iteration trace of one solve
+// Every iteration appends a record to an in-memory ring buffer; a line goes
+// to std::cout every printInterval iterations only, buffered, with a single
+// flush at the end. Objectives are computed for sampled iterations only
+// where an engine does not need them anyway (ADMM between residual checks).
+// The records still in the buffer can be dumped when the solve ends, as CSV
+// (path ending in .csv) or binary, little-endian:
+//
+//	offset 0	TraceHeader (32 bytes)
+//	then count TraceRecords (56 bytes each), oldest first
+
+namespace cvx
+{
+	const static uint32_t traceVersion = 1;
+
+	struct TraceHeader
+	{
+		char magic[8];
+		uint32_t version;
+		uint32_t recordSize;
+		uint64_t count;
+		// records overwritten before the dump
+		uint64_t dropped;
+	};
+	static_assert(sizeof(TraceHeader) == 32, "trace header must be 32 bytes");
+
+	// NaN objectives were not sampled, infinite residuals not checked
+	struct TraceRecord
+	{
+		double_t seconds;
+		double_t primal;
+		double_t dual;
+		double_t primalResidual;
+		double_t dualResidual;
+		double_t gap;
+		int32_t iteration;
+		int32_t reserved;
+	};
+	static_assert(sizeof(TraceRecord) == 56, "trace record must be 56 bytes");
+
+	struct TraceOptions
+	{
+		// iterations between printed lines, 0 prints only the last one
+		int32_t printInterval = 100;
+		// iterations between objective samples where they are optional
+		int32_t sampleInterval = 10;
+		// records kept, older ones are overwritten
+		int32_t capacity = 65536;
+		// dump file, empty for none
+		std::string path;
+	};
+
+	class Trace
+	{
+	public:
+		explicit Trace(const TraceOptions &options);
+
+	public:
+		// whether the objectives of iteration (counted from 1) are wanted
+		bool sampled(int32_t iteration) const;
+		// appends the record of iteration, printing it when due
+		void record(int32_t iteration, double_t primal, double_t dual, const Residuals &residuals = Residuals());
+		// prints the last record unless it already was and a line saying
+		// whether the solve converged, with its residuals; flushes, then dumps
+		// the buffer when a path is set
+		void finish(const Result &result);
+
+		size_t size(void) const { return _records.size(); }
+		// i = 0 is the oldest record kept
+		const TraceRecord &operator[](size_t i) const { return _records[(_next + i) % _records.size()]; }
+
+	private:
+		void print(const TraceRecord &record) const;
+		void dump(void) const;
+
+	private:
+		TraceOptions _options;
+		std::chrono::steady_clock::time_point _start;
+		std::vector<TraceRecord> _records;
+		// slot of the next record once the buffer is full
+		size_t _next;
+		uint64_t _dropped;
+		int32_t _printed;
+	};
+}
+
+#endif /*!_CVX_TRACE_HPP_*/
@@ -0,0 +1,40 @@
+#include <new>
+#include "workspace.hpp"
+
+namespace cvx {
+
+	Workspace::Workspace(void) {}
+
+	Workspace::~Workspace(void)
+	{
+		for (void *buffer : _buffers)
+			mkl_free(buffer);
+	}
+
+	void *Workspace::allocate(size_t bytes)
+	{
+		void *buffer = mkl_malloc(bytes, alignment);
+		if (buffer == nullptr)
+			throw std::bad_alloc();
+		_buffers.push_back(buffer);
+		return buffer;
+	}
+
+	double_t *Workspace::vector(size_t count)
+	{
+		return (double_t*)allocate(count * sizeof(double_t));
+	}
+
+	double_t *Workspace::zeros(size_t count)
+	{
+		double_t *buffer = vector(count);
+		for (size_t i = 0; i < count; ++i)
+			buffer[i] = 0.0;
+		return buffer;
+	}
+
+	int32_t *Workspace::indices(size_t count)
+	{
+		return (int32_t*)allocate(count * sizeof(int32_t));
+	}
+}
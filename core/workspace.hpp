@@ -0,0 +1,35 @@
+#ifndef _CVX_WORKSPACE_HPP_
+#define _CVX_WORKSPACE_HPP_
+
+#include <vector>
+#include "blas.hpp"
+
+namespace cvx
+{
+	const static int32_t alignment = 32;
+
+	// Owner of the aligned scratch buffers of one solve.
+	// Every buffer handed out is released when the workspace goes away, so the
+	// engines no longer pair each mkl_malloc with an mkl_free by hand.
+	class Workspace
+	{
+	public:
+		Workspace(void);
+		~Workspace(void);
+		Workspace(const Workspace &) = delete;
+		Workspace &operator=(const Workspace &) = delete;
+
+	public:
+		double_t *vector(size_t count);
+		double_t *zeros(size_t count);
+		int32_t *indices(size_t count);
+
+	private:
+		void *allocate(size_t bytes);
+
+	private:
+		std::vector<void *> _buffers;
+	};
+}
+
+#endif /*!_CVX_WORKSPACE_HPP_*/
@@ -0,0 +1,71 @@
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <vector>
+#include "drs.hpp"
+#include "kernels.hpp"
+
+// solve_drs on data/ (the directory is the first argument) to a tolerance it
+// cannot reach, so Anderson keeps extrapolating past the point where the
+// residuals stall and the budget ends right after an extrapolation for some
+// budgets. Whatever the budget, the returned x must be as feasible as that of
+// the plain iteration, with the residual reported for it, and x = (z)_+.
+// Exits non-zero on failure.
+
+static int failures = 0;
+
+static void check(bool condition, const char *what, int32_t budget)
+{
+	if (!condition) {
+		std::cerr << "FAILED: " << what << " at budget " << budget << std::endl;
+		++failures;
+	}
+}
+
+static cvx::Result solve(const cvx::Problem &problem, int32_t budget, int32_t memory)
+{
+	cvx::DrsOptions options;
+	options.tolerances.primal = 1e-8;
+	options.tolerances.dual = 1e-8;
+	options.tolerances.gap = 1e-8;
+	options.outerCount = budget;
+	options.andersonMemory = memory;
+	options.trace.printInterval = 0;
+	return cvx::solve_drs(problem, options);
+}
+
+// ||A * x - b|| / (1 + ||b||) from a fresh product
+static double_t primal_residual(const cvx::Problem &problem, const std::vector<double_t> &x)
+{
+	std::vector<double_t> residual(problem.b, problem.b + problem.m);
+	cvx::multiply_A(problem, 1.0, x.data(), -1.0, residual.data());
+	return cvx::primal_infeasibility(problem, residual.data());
+}
+
+int main(int argc, char **argv)
+{
+	if (argc < 2) {
+		std::cerr << "usage: test_drs <data directory>" << std::endl;
+		return 1;
+	}
+	cvx::Problem problem = cvx::load_problem_csv(argv[1]);
+	const double_t plain = primal_residual(problem, solve(problem, 2000, 0).x);
+
+	for (int32_t budget : { 1998, 1999, 2000, 2001, 2998, 3000 }) {
+		cvx::Result result = solve(problem, budget, 10);
+		check(!result.converged && result.iterations == budget, "runs the whole budget", budget);
+		double_t residual = primal_residual(problem, result.x);
+		if (!(residual <= 10.0 * plain)) {
+			std::cerr << "budget " << budget << ": primal residual " << residual << ", plain iteration " << plain << std::endl;
+			check(false, "returned x is as feasible as the plain one", budget);
+		}
+		check(std::abs(result.residuals.primal - residual) <= 1e-3 * residual + 1e-14, "reported residual belongs to x", budget);
+		bool projected = result.z.size() == result.x.size();
+		for (size_t j = 0; projected && j < result.x.size(); ++j)
+			projected = result.x[j] == std::max(result.z[j], 0.0);
+		check(projected, "returned x is the projection of z", budget);
+	}
+	if (failures == 0)
+		std::cout << "test_drs: passed" << std::endl;
+	return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,132 @@
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <vector>
+#include "projection.hpp"
+
+// The AVX-512 and AVX2 projection kernels against the scalar ones, bit for
+// bit: every length up to three vectors of eight (so every remainder of the
+// tails), unaligned starts, and inputs with NaN, +-0, +-inf and subnormals.
+// ISAs the CPU lacks are skipped. Exits non-zero on failure.
+
+static int failures = 0;
+
+static bool same_bits(const double_t *a, const double_t *b, int32_t n)
+{
+	return n == 0 || std::memcmp(a, b, sizeof(double_t) * n) == 0;
+}
+
+static void report(const char *isa, const char *kernel, int32_t n, int32_t offset)
+{
+	std::cerr << "FAILED: " << isa << " " << kernel << " differs from scalar at n = " << n << ", offset " << offset << std::endl;
+	++failures;
+}
+
+// mostly random values with the special ones mixed in
+static std::vector<double_t> values(std::mt19937_64 &generator, size_t count)
+{
+	const double_t specials[] = {
+		std::numeric_limits<double_t>::quiet_NaN(), -std::numeric_limits<double_t>::quiet_NaN(),
+		0.0, -0.0, std::numeric_limits<double_t>::infinity(), -std::numeric_limits<double_t>::infinity(),
+		std::numeric_limits<double_t>::denorm_min(), -std::numeric_limits<double_t>::denorm_min(),
+		std::numeric_limits<double_t>::max(), -std::numeric_limits<double_t>::max()
+	};
+	const size_t specialCount = sizeof(specials) / sizeof(specials[0]);
+	std::normal_distribution<double_t> normal;
+	std::vector<double_t> out(count);
+	for (double_t &value : out) {
+		uint64_t pick = generator() % 4;
+		value = pick == 0 ? specials[generator() % specialCount] : normal(generator);
+	}
+	return out;
+}
+
+static void compare(const cvx::ProjectionKernels &reference, const cvx::ProjectionKernels &tested, std::mt19937_64 &generator)
+{
+	const int32_t longest = 3 * 8 + 8;
+	const double_t alphas[] = { 1.0, -1.0, 0.5, -0.0 };
+	const double_t sigmas[] = { 0.01, 1.0, 0.0 };
+	for (int32_t n = 0; n <= longest; ++n) {
+		for (int32_t offset = 0; offset < 2; ++offset) {
+			std::vector<double_t> v = values(generator, n + offset);
+			std::vector<double_t> x = values(generator, n + offset);
+			std::vector<double_t> c = values(generator, n + offset);
+			std::vector<double_t> aty = values(generator, n + offset);
+			std::vector<double_t> expected(n + offset);
+			std::vector<double_t> actual(n + offset);
+
+			for (double_t alpha : alphas) {
+				reference.nonneg(n, alpha, v.data() + offset, expected.data() + offset);
+				tested.nonneg(n, alpha, v.data() + offset, actual.data() + offset);
+				if (!same_bits(expected.data() + offset, actual.data() + offset, n))
+					report(tested.isa, "nonneg", n, offset);
+			}
+
+			//in place
+			expected = v;
+			actual = v;
+			reference.nonneg(n, 1.0, expected.data() + offset, expected.data() + offset);
+			tested.nonneg(n, 1.0, actual.data() + offset, actual.data() + offset);
+			if (!same_bits(expected.data() + offset, actual.data() + offset, n))
+				report(tested.isa, "nonneg in place", n, offset);
+
+			expected = v;
+			actual = v;
+			std::vector<int32_t> expectedActive(n + 1, -1);
+			std::vector<int32_t> actualActive(n + 1, -1);
+			int32_t expectedCount = reference.nonnegActive(n, expected.data() + offset, expectedActive.data());
+			int32_t actualCount = tested.nonnegActive(n, actual.data() + offset, actualActive.data());
+			if (expectedCount != actualCount || !same_bits(expected.data() + offset, actual.data() + offset, n)
+				|| std::memcmp(expectedActive.data(), actualActive.data(), sizeof(int32_t) * expectedCount) != 0)
+				report(tested.isa, "nonnegActive", n, offset);
+
+			for (double_t sigma : sigmas) {
+				reference.shifted(n, x.data() + offset, c.data() + offset, sigma, aty.data() + offset, expected.data() + offset);
+				tested.shifted(n, x.data() + offset, c.data() + offset, sigma, aty.data() + offset, actual.data() + offset);
+				if (!same_bits(expected.data() + offset, actual.data() + offset, n))
+					report(tested.isa, "shifted", n, offset);
+			}
+
+			//out aliasing aty
+			expected = aty;
+			actual = aty;
+			reference.shifted(n, x.data() + offset, c.data() + offset, 0.01, expected.data() + offset, expected.data() + offset);
+			tested.shifted(n, x.data() + offset, c.data() + offset, 0.01, actual.data() + offset, actual.data() + offset);
+			if (!same_bits(expected.data() + offset, actual.data() + offset, n))
+				report(tested.isa, "shifted in place", n, offset);
+		}
+	}
+}
+
+int main(void)
+{
+	std::mt19937_64 generator(11);
+	cvx::ProjectionKernels scalar;
+	if (!cvx::projection_kernels("scalar", scalar)) {
+		std::cerr << "FAILED: no scalar kernels" << std::endl;
+		return 1;
+	}
+
+	//NaN and -0 map to +0, as the kernels promise
+	const double_t special[] = { std::numeric_limits<double_t>::quiet_NaN(), -0.0, -1.0, 2.0 };
+	double_t projected[4];
+	scalar.nonneg(4, 1.0, special, projected);
+	if (std::signbit(projected[0]) || projected[0] != 0.0 || std::signbit(projected[1]) || projected[1] != 0.0 || projected[2] != 0.0 || projected[3] != 2.0) {
+		std::cerr << "FAILED: scalar nonneg of NaN, -0, -1, 2" << std::endl;
+		++failures;
+	}
+
+	for (const char *isa : { "avx2", "avx512" }) {
+		cvx::ProjectionKernels tested;
+		if (!cvx::projection_kernels(isa, tested)) {
+			std::cout << "test_projection: " << isa << " not supported, skipped" << std::endl;
+			continue;
+		}
+		compare(scalar, tested, generator);
+	}
+	if (failures == 0)
+		std::cout << "test_projection: passed, dispatching to " << cvx::projection_isa() << std::endl;
+	return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,226 @@
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+#include "kernels.hpp"
+#include "linear_solver.hpp"
+
+// SpdSolver::rank_one and active_changes against a fresh dpotrf: a chain of
+// updates and downdates of one factor, the active-set changes SSN carries
+// over, and a downdate that loses definiteness. Exits non-zero on failure.
+
+static int failures = 0;
+
+static void check(bool condition, const char *what)
+{
+	if (!condition) {
+		std::cerr << "FAILED: " << what << std::endl;
+		++failures;
+	}
+}
+
+// largest difference of carried^-1 * e_i and fresh^-1 * e_i over all i,
+// relative to the largest entry of fresh^-1
+static double_t inverse_difference(const cvx::SpdSolver &carried, const cvx::SpdSolver &fresh, int32_t m)
+{
+	std::vector<double_t> a(m);
+	std::vector<double_t> b(m);
+	double_t difference = 0.0;
+	double_t scale = 0.0;
+	for (int32_t i = 0; i < m; ++i) {
+		std::fill(a.begin(), a.end(), 0.0);
+		a[i] = 1.0;
+		b = a;
+		carried.solve(a.data());
+		fresh.solve(b.data());
+		for (int32_t k = 0; k < m; ++k) {
+			difference = std::max(difference, std::abs(a[k] - b[k]));
+			scale = std::max(scale, std::abs(b[k]));
+		}
+	}
+	return difference / scale;
+}
+
+// matrix += sign * v * v^T, row-major m x m
+static void add_outer(std::vector<double_t> &matrix, const std::vector<double_t> &v, double_t sign)
+{
+	const size_t m = v.size();
+	for (size_t i = 0; i < m; ++i) {
+		for (size_t k = 0; k < m; ++k) {
+			matrix[i * m + k] += sign * v[i] * v[k];
+		}
+	}
+}
+
+static void test_chain(std::mt19937_64 &generator)
+{
+	const int32_t m = 12;
+	std::normal_distribution<double_t> normal;
+	std::vector<std::vector<double_t>> vectors(6, std::vector<double_t>(m));
+	for (std::vector<double_t> &v : vectors) {
+		for (double_t &value : v)
+			value = normal(generator);
+	}
+
+	//M = I + v0 v0^T + ... + v5 v5^T
+	std::vector<double_t> matrix((size_t)m * m, 0.0);
+	for (int32_t i = 0; i < m; ++i)
+		matrix[(size_t)i * m + i] = 1.0;
+	for (const std::vector<double_t> &v : vectors)
+		add_outer(matrix, v, 1.0);
+
+	cvx::SpdSolver carried;
+	carried.factor(matrix.data(), m);
+	check(carried.method() == cvx::SpdSolver::eCHOLESKY, "chain: initial Cholesky");
+
+	//downdates back to I, then updates in a different order
+	const int32_t steps[] = { ~0, ~3, ~5, 3, ~1, 0, ~2, ~4, ~3, ~0, 2, 4, 1 };
+	for (int32_t step : steps) {
+		bool entering = step >= 0;
+		std::vector<double_t> &v = vectors[entering ? step : ~step];
+		std::vector<double_t> scratch = v;
+		check(carried.rank_one(scratch.data(), entering ? 1.0 : -1.0), "chain: rank_one succeeds");
+		add_outer(matrix, v, entering ? 1.0 : -1.0);
+
+		cvx::SpdSolver fresh;
+		fresh.factor(matrix.data(), m);
+		check(fresh.method() == cvx::SpdSolver::eCHOLESKY, "chain: fresh Cholesky");
+		double_t difference = inverse_difference(carried, fresh, m);
+		if (!(difference < 1e-10)) {
+			std::cerr << "chain step " << step << ": relative difference " << difference << std::endl;
+			check(false, "chain: carried factor matches dpotrf");
+		}
+	}
+}
+
+// the SSN loop on a small dense A: the factor of sigma * A_P * A_P^T + mu * I
+// carried across active sets P by active_changes and rank_one
+static void test_active_sets(std::mt19937_64 &generator)
+{
+	const int32_t m = 8;
+	const int32_t n = 40;
+	const double_t sigma = 0.5;
+	const double_t mu = 0.1;
+	std::normal_distribution<double_t> normal;
+	std::bernoulli_distribution keep(0.5);
+
+	std::vector<double_t> A((size_t)m * n);
+	for (double_t &value : A)
+		value = normal(generator);
+	cvx::Problem problem;
+	problem.m = m;
+	problem.n = n;
+	problem.layout = cvx::eROW_MAJOR;
+	problem.A = A.data();
+
+	std::vector<double_t> jacobian((size_t)m * m);
+	std::vector<double_t> gathered;
+	auto build = [&](const std::vector<int32_t> &active, cvx::SpdSolver &solver) {
+		cvx::gram_columns(problem, active.data(), (int32_t)active.size(), sigma, 0.0, jacobian.data(), gathered);
+		for (int32_t i = 0; i < m; ++i)
+			jacobian[(size_t)i * m + i] += mu;
+		solver.factor(jacobian.data(), m);
+	};
+
+	std::vector<int32_t> previous;
+	for (int32_t j = 0; j < n; ++j) {
+		if (keep(generator))
+			previous.push_back(j);
+	}
+	cvx::SpdSolver carried;
+	build(previous, carried);
+
+	std::vector<int32_t> changed(n + 1);
+	std::vector<double_t> column(m);
+	for (int32_t round = 0; round < 20; ++round) {
+		//flip a few random indices
+		std::vector<int32_t> current;
+		std::vector<bool> flip(n, false);
+		for (int32_t k = 0; k < 3; ++k)
+			flip[generator() % n] = true;
+		size_t p = 0;
+		for (int32_t j = 0; j < n; ++j) {
+			bool in = p < previous.size() && previous[p] == j;
+			if (in)
+				++p;
+			if (in != flip[j])
+				current.push_back(j);
+		}
+
+		int32_t changes = cvx::active_changes(previous.data(), (int32_t)previous.size(), current.data(), (int32_t)current.size(), n, changed.data());
+		int32_t flipped = (int32_t)std::count(flip.begin(), flip.end(), true);
+		check(changes == flipped, "active sets: every flipped index is reported once");
+		for (int32_t i = 0; i < changes; ++i) {
+			int32_t j = changed[i] >= 0 ? changed[i] : ~changed[i];
+			check(flip[j], "active sets: only flipped indices are reported");
+			check((changed[i] >= 0) == std::binary_search(current.begin(), current.end(), j), "active sets: sign tells entering from leaving");
+		}
+		//updates before downdates, as in solve_ssn
+		for (int32_t pass = 0; pass < 2; ++pass) {
+			for (int32_t i = 0; i < changes; ++i) {
+				bool entering = changed[i] >= 0;
+				if (entering != (pass == 0))
+					continue;
+				cvx::column_of_A(problem, entering ? changed[i] : ~changed[i], std::sqrt(sigma), column.data());
+				check(carried.rank_one(column.data(), entering ? 1.0 : -1.0), "active sets: rank_one succeeds");
+			}
+		}
+
+		cvx::SpdSolver fresh;
+		build(current, fresh);
+		double_t difference = inverse_difference(carried, fresh, m);
+		if (!(difference < 1e-10)) {
+			std::cerr << "active sets round " << round << ": relative difference " << difference << std::endl;
+			check(false, "active sets: carried factor matches dpotrf");
+		}
+		previous = current;
+	}
+
+	//more than limit changes stop the scan at limit + 1
+	std::vector<int32_t> none;
+	std::vector<int32_t> all(n);
+	for (int32_t j = 0; j < n; ++j)
+		all[j] = j;
+	check(cvx::active_changes(none.data(), 0, all.data(), n, 5, changed.data()) == 6, "active sets: limit + 1 past the limit");
+	check(cvx::active_changes(all.data(), n, all.data(), n, 0, changed.data()) == 0, "active sets: equal sets do not differ");
+}
+
+static void test_lost_definiteness(void)
+{
+	//M = 0.01 * I + v * v^T, M - 4 * v * v^T is indefinite
+	const int32_t m = 5;
+	std::vector<double_t> v = { 1.0, -2.0, 0.5, 3.0, 1.5 };
+	std::vector<double_t> matrix((size_t)m * m, 0.0);
+	for (int32_t i = 0; i < m; ++i)
+		matrix[(size_t)i * m + i] = 0.01;
+	add_outer(matrix, v, 1.0);
+
+	cvx::SpdSolver solver;
+	solver.factor(matrix.data(), m);
+	std::vector<double_t> scratch(v);
+	for (double_t &value : scratch)
+		value *= 2.0;
+	check(!solver.rank_one(scratch.data(), -1.0), "lost definiteness: rank_one fails");
+	check(!solver.factored(), "lost definiteness: the factor is dropped");
+	bool threw = false;
+	std::vector<double_t> rhs(m, 1.0);
+	try { solver.solve(rhs.data()); }
+	catch (const cvx::Error &) { threw = true; }
+	check(threw, "lost definiteness: solve needs a new factor");
+
+	//an update without a Cholesky factor is refused as well
+	scratch = v;
+	check(!solver.rank_one(scratch.data(), 1.0), "lost definiteness: no factor, no update");
+}
+
+int main(void)
+{
+	std::mt19937_64 generator(7);
+	test_chain(generator);
+	test_active_sets(generator);
+	test_lost_definiteness();
+	if (failures == 0)
+		std::cout << "test_rank_one: passed" << std::endl;
+	return failures == 0 ? 0 : 1;
+}
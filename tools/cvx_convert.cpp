@@ -0,0 +1,36 @@
+#include <iostream>
+#include <string>
+#include "binary.hpp"
+
+// usage: cvx_convert <csv directory> <output file> [row|col|csr]
+// converts A.csv, b.csv and c.csv into the binary problem format, A is stored
+// row-major unless col or csr is given
+
+int main(int argc, char** argv) {
+	if (argc < 3 || argc > 4) {
+		std::cerr << "usage: " << argv[0] << " <csv directory> <output file> [row|col|csr]" << std::endl;
+		return 2;
+	}
+
+	cvx::Layout layout = cvx::eROW_MAJOR;
+	if (argc == 4) {
+		std::string name = argv[3];
+		if (name == "col") { layout = cvx::eCOL_MAJOR; }
+		else if (name == "csr") { layout = cvx::eCSR; }
+		else if (name != "row") {
+			std::cerr << "unknown layout " << name << std::endl;
+			return 2;
+		}
+	}
+
+	try {
+		cvx::Problem problem = cvx::load_problem_csv(argv[1]);
+		cvx::write_problem_binary(problem, argv[2], layout);
+		std::cout << argv[2] << ": m = " << problem.m << ", n = " << problem.n << std::endl;
+	}
+	catch (const std::exception &e) {
+		std::cerr << e.what() << std::endl;
+		return 1;
+	}
+	return 0;
+}
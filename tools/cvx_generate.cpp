@@ -0,0 +1,64 @@
+#include <cerrno>
+#include <iostream>
+#include <string>
+#include <sys/stat.h>
+#include "generator.hpp"
+
+// usage: cvx_generate <output> [--m m] [--n n] [--density d] [--seed s]
+//	[--csv] [--threads k]
+// writes the gendata.m instance of the given size and seed (see generator.hpp)
+// as a binary problem, row-major or CSR when density < 1, or with --csv as
+// A.csv, b.csv and c.csv in the output directory, which is created. A is
+// streamed row by row, so instances far larger than memory can be written.
+
+int main(int argc, char** argv) {
+	if (argc < 2) {
+		std::cerr << "usage: " << argv[0] << " <output> [--m m] [--n n] [--density d] [--seed s] [--csv] [--threads k]" << std::endl;
+		return 2;
+	}
+
+	cvx::GeneratorOptions options;
+	bool csv = false;
+	int32_t threads = 0;
+	try {
+		for (int i = 2; i < argc; ++i) {
+			std::string arg = argv[i];
+			if (arg == "--csv") {
+				csv = true;
+				continue;
+			}
+			if (i + 1 == argc)
+				throw cvx::Error(arg + " needs a value");
+			std::string value = argv[++i];
+			if (arg == "--m") { options.m = std::stoi(value); }
+			else if (arg == "--n") { options.n = std::stoi(value); }
+			else if (arg == "--density") { options.density = std::stod(value); }
+			else if (arg == "--seed") { options.seed = std::stoull(value); }
+			else if (arg == "--threads") { threads = std::stoi(value); }
+			else { throw cvx::Error("unknown option " + arg); }
+		}
+	}
+	catch (const std::exception &e) {
+		std::cerr << e.what() << std::endl;
+		return 2;
+	}
+
+	try {
+		double_t objective;
+		if (csv) {
+			if (mkdir(argv[1], 0777) != 0 && errno != EEXIST)
+				throw cvx::Error(std::string("Failed to create ").append(argv[1]));
+			objective = cvx::write_generated_csv(options, argv[1], threads);
+		}
+		else {
+			objective = cvx::write_generated_binary(options, argv[1], threads);
+		}
+		std::cout.precision(10);
+		std::cout << argv[1] << ": m = " << options.m << ", n = " << options.n << ", optimum = " << objective << std::endl;
+	}
+	catch (const std::exception &e) {
+		std::cerr << e.what() << std::endl;
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,136 @@
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "admm.hpp"
+#include "alm.hpp"
+#include "drs.hpp"
+#include "pool.hpp"
+#include "ssn.hpp"
+
+// usage: cvx_pool [--workers w] [--engine alm|ssn|admm|drs] [--tolerance eps]
+//	[--large entries] [--large-cores k] problem...
+// solves every problem (binary file or CSV directory) as its own job on a
+// pool of w workers (default: one per hardware thread). Problems whose A has
+// at least entries entries (default 1e7) run with k cores for their BLAS
+// calls (default 4, MKL only), the others sequentially. Prints one line per
+// problem, in the order given:
+// problem,engine,m,n,iterations,converged,primal,dual,seconds
+
+// swallows the per-iteration lines the engines print from every worker
+class NullBuffer : public std::streambuf
+{
+protected:
+	int overflow(int c) override { return traits_type::not_eof(c); }
+	std::streamsize xsputn(const char *, std::streamsize count) override { return count; }
+};
+
+struct Job
+{
+	std::string path;
+	cvx::Problem problem;
+	int32_t m = 0;
+	int32_t n = 0;
+	cvx::Result result;
+	double seconds = 0.0;
+};
+
+int main(int argc, char** argv) {
+	int32_t workers = 0;
+	std::string engine = "admm";
+	cvx::Tolerances tolerances;
+	double_t large = 1e7;
+	int32_t largeCores = 4;
+	std::vector<Job> jobs;
+	try {
+		for (int i = 1; i < argc; ++i) {
+			std::string arg = argv[i];
+			bool valued = arg == "--workers" || arg == "--engine" || arg == "--tolerance" || arg == "--large" || arg == "--large-cores";
+			if (valued && ++i == argc)
+				throw cvx::Error(arg + " needs a value");
+			if (arg == "--workers") { workers = std::stoi(argv[i]); }
+			else if (arg == "--engine") { engine = argv[i]; }
+			else if (arg == "--tolerance") { tolerances.primal = tolerances.dual = tolerances.gap = std::stod(argv[i]); }
+			else if (arg == "--large") { large = std::stod(argv[i]); }
+			else if (arg == "--large-cores") { largeCores = std::stoi(argv[i]); }
+			else if (arg.size() > 1 && arg[0] == '-') { throw cvx::Error("unknown option " + arg); }
+			else {
+				jobs.emplace_back();
+				jobs.back().path = arg;
+			}
+		}
+		if (engine != "alm" && engine != "ssn" && engine != "admm" && engine != "drs")
+			throw cvx::Error("unknown engine " + engine);
+		if (jobs.empty())
+			throw cvx::Error("no problems given");
+	}
+	catch (const std::exception &e) {
+		std::cerr << e.what() << std::endl;
+		std::cerr << "usage: " << argv[0] << " [--workers w] [--engine alm|ssn|admm|drs] [--tolerance eps] [--large entries] [--large-cores k] problem..." << std::endl;
+		return 2;
+	}
+
+	try {
+		std::ostream out(std::cout.rdbuf());
+		NullBuffer null;
+		std::cout.rdbuf(&null);
+
+		std::vector<std::future<void>> futures;
+		{
+			cvx::SolverPool pool(workers);
+			for (Job &job : jobs) {
+				job.problem = cvx::load_problem(job.path);
+				job.m = job.problem.m;
+				job.n = job.problem.n;
+				int32_t cores = (double_t)job.problem.m * job.problem.n >= large ? largeCores : 1;
+				futures.push_back(pool.submit([&job, &engine, &tolerances]() {
+					auto start = std::chrono::steady_clock::now();
+					if (engine == "alm") {
+						cvx::AlmOptions options;
+						options.tolerances = tolerances;
+						job.result = cvx::solve_alm(job.problem, options);
+					}
+					else if (engine == "ssn") {
+						cvx::SsnOptions options;
+						options.tolerances = tolerances;
+						job.result = cvx::solve_ssn(job.problem, options);
+					}
+					else if (engine == "admm") {
+						cvx::AdmmOptions options;
+						options.tolerances = tolerances;
+						job.result = cvx::solve_admm(job.problem, options);
+					}
+					else {
+						cvx::DrsOptions options;
+						options.tolerances = tolerances;
+						job.result = cvx::solve_drs(job.problem, options);
+					}
+					job.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+					//releases A as soon as the job is done
+					job.problem = cvx::Problem();
+				}, cores));
+			}
+		}
+
+		out << "problem,engine,m,n,iterations,converged,primal,dual,seconds" << std::endl;
+		int status = 0;
+		for (size_t i = 0; i < jobs.size(); ++i) {
+			const Job &job = jobs[i];
+			try {
+				futures[i].get();
+				out << job.path << "," << engine << "," << job.m << "," << job.n << "," << job.result.iterations
+					<< "," << job.result.converged << "," << job.result.primal << "," << job.result.dual << "," << job.seconds << std::endl;
+			}
+			catch (const std::exception &e) {
+				std::cerr << job.path << ": " << e.what() << std::endl;
+				status = 1;
+			}
+		}
+		std::cout.rdbuf(out.rdbuf());
+		return status;
+	}
+	catch (const std::exception &e) {
+		std::cerr << e.what() << std::endl;
+		return 1;
+	}
+}